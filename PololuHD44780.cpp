@@ -11,127 +11,810 @@
 #define LCD_SHIFT_L     0x18
 #define LCD_SHIFT_R     0x1C
 
+// Converts a DDRAM address to an index in PololuHD44780Framebuffer::cells.
+static uint8_t ddramIndex(uint8_t address)
+{
+    return ((address & 0x40) ? 40 : 0) + (address & 0x3F) % 40;
+}
+
+// Converts an index in PololuHD44780Framebuffer::cells to a DDRAM address.
+static uint8_t ddramAddress(uint8_t index)
+{
+    return index < 40 ? index : (0x40 + index - 40);
+}
+
 PololuHD44780Base::PololuHD44780Base()
 {
-    initialized = false;
+    initStage = 0;
+    initTime = 0;
+    initDelay = 0;
+    busyFlagUsed = false;
+    address = 0xFF;
+    addressInCgram = false;
+    shift = 0;
+    wrapAddress = 0xFF;
+    occupiedStart[0] = occupiedStart[1] = 0;
+    occupiedEnd[0] = occupiedEnd[1] = 40;
+    framebuffer = NULL;
+    queue = NULL;
+    fields = NULL;
+    trace = NULL;
+    updateDepth = 0;
+
+#if POLOLU_HD44780_STATS
+    stats.reset();
+    statsApi = PololuHD44780Stats::other;
+#endif
 }
 
 void PololuHD44780Base::init2()
 {
-    // The startup procedure comes from Figure 24 of the HD44780 datasheet.  The
-    // delay times in the later part of this function come from Table 6.
+#if POLOLU_HD44780_STATS
+    uint8_t savedStatsApi = statsApi;
+    statsApi = PololuHD44780Stats::init;
+#endif
+
+    if (initStage == 0)
+    {
+        initStart();
+    }
+    else if (busyFlagUsed)
+    {
+        // Finish waiting for the last step done by initStep().
+        waitWhileBusy();
+    }
+    else
+    {
+        uint16_t elapsed = micros() - initTime;
+        if (elapsed < initDelay)
+        {
+            delayMicroseconds(initDelay - elapsed);
+#if POLOLU_HD44780_STATS
+            countDelay(initDelay - elapsed);
+#endif
+        }
+    }
+
+    while (initStage != initDone)
+    {
+        uint16_t delayTime = initNext();
+        if (busyFlagUsed)
+        {
+            waitWhileBusy();
+        }
+        else
+        {
+            delayMicroseconds(delayTime);
+#if POLOLU_HD44780_STATS
+            countDelay(delayTime);
+#endif
+        }
+    }
+
+#if POLOLU_HD44780_STATS
+    statsApi = savedStatsApi;
+#endif
+}
+
+void PololuHD44780Base::beginAsync()
+{
+    initStart();
+    initTime = micros();
+    initDelay = 0;
+}
+
+bool PololuHD44780Base::initStep()
+{
+    if (initStage == initDone) { return true; }
+    if (initStage == 0) { beginAsync(); }
+
+    if (busyFlagUsed)
+    {
+        if (receive(false) & 0x80) { return false; }
+    }
+    else if ((uint16_t)((uint16_t)micros() - initTime) < initDelay)
+    {
+        return false;
+    }
+
+    initDelay = initNext();
+    initTime = micros();
+    return initStage == initDone;
+}
+
+void PololuHD44780Base::initStart()
+{
+    // Anything waiting in the queue was meant for the LCD before it was
+    // reinitialized.
+    if (queue) { drainQueue(); }
+
+#if POLOLU_HD44780_STATS
+    stats.api[PololuHD44780Stats::init].calls++;
+#endif
+
+    // The busy flag cannot be read until the interface is configured.
+    busyFlagUsed = false;
 
     initPins();
+    initStage = 1;
 
     // We need to wait at least 15 ms after VCC reaches 4.5 V.
     //
     // Assumption: The AVR's power-on reset is already configured to wait for
     // tens of milliseconds, so no delay is needed here.
+}
 
-    sendCommand4Bit(3);        // Function set
-    _delay_us(4200);           // Needs to be at least 4.1 ms.
-    sendCommand4Bit(3);        // Function set
-    _delay_us(150);            // Needs to be at least 100 us.
-    sendCommand4Bit(3);        // Function set
+// Performs the next step of the initialization sequence and returns how many
+// microseconds to wait before the step after it.  The initialization
+// transfers are always sent directly, never queued.
+uint16_t PololuHD44780Base::initNext()
+{
+    // The startup procedure comes from Figure 24 of the HD44780 datasheet.  The
+    // delay times in the later part of this function come from Table 6.
 
-    sendCommand4Bit(0b0010);   // 4-bit interface
-    sendCommand(0b00101000);   // 4-bit, 2 line, 5x8 dots font
+    bool eightBit = eightBitInterface();
+    switch (initStage++)
+    {
+    case 1:
+        // Function set; needs at least 4.1 ms.
+        return initTransfer(eightBit ? 0b00110000 : 0b0011, !eightBit, 4200);
 
-    setDisplayControl(0b000);  // display off, cursor off, blinking off
-    clear();
-    setEntryMode(0b10);        // cursor shifts right, no auto-scrolling
-    setDisplayControl(0b100);  // display on, cursor off, blinking off
+    case 2:
+        // Function set; needs at least 100 us.
+        return initTransfer(eightBit ? 0b00110000 : 0b0011, !eightBit, 150);
+
+    case 3:
+        // Function set
+        return initTransfer(eightBit ? 0b00110000 : 0b0011, !eightBit,
+            timing.command);
+
+    case 4:
+        if (eightBit)
+        {
+            // 8-bit, 2 line, 5x8 dots font
+            initStage++;
+            return initTransfer(0b00111000, false, timing.command);
+        }
+        else
+        {
+            // 4-bit interface
+            return initTransfer(0b0010, true, timing.command);
+        }
+
+    case 5:
+        // 4-bit, 2 line, 5x8 dots font
+        return initTransfer(0b00101000, false, timing.command);
+
+    case 6:
+        // From now on, use the busy flag if the subclass can read it.
+        busyFlagUsed = receive(false) >= 0;
+
+        displayControl = 0b000;  // display off, cursor off, blinking off
+        sentDisplayControl = displayControl;
+        return initTransfer(0b00001000 | displayControl, false,
+            timing.command);
+
+    case 7:
+        clearFields();
+        return initTransfer(LCD_CLEAR, false, timing.clear);
+
+    case 8:
+        entryMode = 0b10;  // cursor shifts right, no auto-scrolling
+        sentEntryMode = entryMode;
+        return initTransfer(0b00000100 | entryMode, false, timing.command);
+
+    case 9:
+        displayControl = 0b100;  // display on, cursor off, blinking off
+        sentDisplayControl = displayControl;
+        return initTransfer(0b00001000 | displayControl, false,
+            timing.command);
+
+    default:
+        initStage = initDone;
+        return 0;
+    }
 }
 
-void PololuHD44780Base::sendAndDelay(uint8_t data, bool rsValue, bool only4bit)
+// Sends one transfer of the initialization sequence and returns the delay
+// time, which is only needed here for the trace.
+uint16_t PololuHD44780Base::initTransfer(uint8_t data, bool only4bit,
+    uint16_t delayTime)
+{
+    trackTransfer(data, false, only4bit);
+    traceTransfer(data, false, only4bit, delayTime);
+
+#if POLOLU_HD44780_STATS
+    uint8_t savedStatsApi = statsApi;
+    statsApi = PololuHD44780Stats::init;
+    countTransfer(data, false, only4bit);
+    statsApi = savedStatsApi;
+#endif
+
+    send(data, false, only4bit);
+    return delayTime;
+}
+
+void PololuHD44780Base::sendAndDelay(uint8_t data, bool rsValue, bool only4bit,
+    uint16_t delayTime)
 {
     init();
 
+    // Characters must be written with the entry mode the caller asked for.
+    if (rsValue && entryMode != sentEntryMode) { sendEntryMode(); }
+
+    trackTransfer(data, rsValue, only4bit);
+    traceTransfer(data, rsValue, only4bit, delayTime);
+#if POLOLU_HD44780_STATS
+    countTransfer(data, rsValue, only4bit);
+#endif
+
+    if (queue)
+    {
+        enqueue(data, (rsValue ? PololuHD44780Queue::rsFlag : 0) |
+            (only4bit ? PololuHD44780Queue::only4bitFlag : 0), delayTime);
+        return;
+    }
+
+    if (busyFlagUsed)
+    {
+        // Wait for the previous command to finish, however long it took.
+        waitWhileBusy();
+        send(data, rsValue, only4bit);
+        return;
+    }
+
     send(data, rsValue, only4bit);
 
     // Every data transfer or command takes at least 37 us to complete, and most
-    // of them only take that long according to the HD44780 datasheet.  We delay
-    // for 37 us here so we don't have to do it in lots of other places.
+    // of them only take that long according to the HD44780 datasheet.  The
+    // caller tells us how long to delay so we don't have to do it in lots of
+    // other places.
     //
-    // NOTE: If we add support for configurations where the R/W line is
-    // connected, then this delay and others like it should be disabled, and we
-    // should instead wait for the busy flag before sending the next command.
-    _delay_us(37);
+    // This delay is skipped if we are using the busy flag.
+    delayAfterSend(delayTime);
+}
+
+void PololuHD44780Base::delayAfterSend(uint16_t delayTime)
+{
+    // The next transfer cannot reach the LCD until at least sendTime() after
+    // it starts, so we do not need to wait for that part.
+    uint16_t alreadyElapsed = sendTime();
+    if (delayTime > alreadyElapsed)
+    {
+        delayMicroseconds(delayTime - alreadyElapsed);
+#if POLOLU_HD44780_STATS
+        countDelay(delayTime - alreadyElapsed);
+#endif
+    }
+}
+
+void PololuHD44780Base::sendBlock(const uint8_t * data, size_t length, bool rsValue)
+{
+    while (length--)
+    {
+        send(*data++, rsValue, false);
+        waitForData();
+    }
+}
+
+void PololuHD44780Base::sendDataBlock(const uint8_t * data, size_t length)
+{
+    init();
+
+    if (entryMode != sentEntryMode) { sendEntryMode(); }
+
+    if (queue || busyFlagUsed)
+    {
+        // Each byte needs to be queued or wait for the busy flag separately.
+        while (length--)
+        {
+            sendData(*data++);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < length; i++)
+    {
+        trackTransfer(data[i], true, false);
+        traceTransfer(data[i], true, false, timing.data);
+#if POLOLU_HD44780_STATS
+        countTransfer(data[i], true, false);
+#endif
+    }
+    sendBlock(data, length, true);
+}
+
+// Updates our copies of the LCD's address counter and display shift, and the
+// occupied parts of DDRAM, to account for a transfer.
+void PololuHD44780Base::trackTransfer(uint8_t data, bool rsValue, bool only4bit)
+{
+    if (only4bit)
+    {
+        // Only sent during initialization.
+        address = 0xFF;
+    }
+    else if (rsValue)
+    {
+        // Writing to CGRAM does not affect the display.
+        if (addressInCgram) { return; }
+
+        trackData(data);
+
+        // Auto-scrolling shifts the display in the same direction as the
+        // address counter but does not change the address counter.
+        if (entryMode & 0b01)
+        {
+            shift = (entryMode & 0b10) ? (shift + 1) % 40 : (shift + 39) % 40;
+        }
+
+        // Writing data moves the address counter in the direction specified by
+        // the I/D bit.
+        if (address == 0xFF) { return; }
+        if (entryMode & 0b10)
+        {
+            address++;
+            if (address == 0x28) { address = 0x40; }
+            else if (address == 0x68) { address = 0x00; }
+        }
+        else
+        {
+            if (address == 0x00) { address = 0x67; }
+            else if (address == 0x40) { address = 0x27; }
+            else { address--; }
+        }
+    }
+    else if (data & 0x80)
+    {
+        // Set DDRAM address.  We do not try to keep track of what happens
+        // after going to one of the addresses that does not exist.
+        address = data & 0x7F;
+        if ((address & 0x3F) >= 40 || address >= 0x68) { address = 0xFF; }
+        addressInCgram = false;
+        wrapAddress = 0xFF;
+    }
+    else if (data & 0x40)
+    {
+        // Set CGRAM address
+        address = 0xFF;
+        addressInCgram = true;
+        wrapAddress = 0xFF;
+    }
+    else if ((data & 0xF8) == 0x18)
+    {
+        // Display shift; the address counter does not change.
+        shift = (data & 0x04) ? (shift + 39) % 40 : (shift + 1) % 40;
+    }
+    else if ((data & 0xF8) == 0x10)
+    {
+        // Cursor shift
+        address = 0xFF;
+        wrapAddress = 0xFF;
+    }
+    else if ((data & 0xF8) == 0x08)
+    {
+        // Display on/off control, which might have been sent with command().
+        displayControl = sentDisplayControl = data & 0b111;
+    }
+    else if ((data & 0xFC) == 0x04)
+    {
+        // Entry mode set, which might have been sent with command().
+        entryMode = sentEntryMode = data & 0b11;
+    }
+    else if ((data & 0xFE) == 0x02)
+    {
+        // Return home
+        address = 0;
+        addressInCgram = false;
+        shift = 0;
+        wrapAddress = 0xFF;
+    }
+    else if (data == LCD_CLEAR)
+    {
+        // Clearing the display also sets the I/D bit.
+        address = 0;
+        addressInCgram = false;
+        shift = 0;
+        wrapAddress = 0xFF;
+        entryMode |= 0b10;
+        sentEntryMode |= 0b10;
+        clearOccupied();
+
+        // This only happens in framebuffer mode if the LCD is being
+        // initialized or the command was sent with command(), so the
+        // framebuffer's cells still need to be shown by the next flush.
+        if (framebuffer)
+        {
+            memset(framebuffer->shown, ' ', sizeof(framebuffer->shown));
+        }
+    }
+}
+
+// Records that a character is being written to DDRAM at the address counter.
+void PololuHD44780Base::trackData(uint8_t data)
+{
+    // Spaces do not make the LCD look any different from a cleared one.
+    if (data == ' ') { return; }
+
+    if (address == 0xFF)
+    {
+        // We do not know where it went, so it could be anywhere.
+        occupiedStart[0] = occupiedStart[1] = 0;
+        occupiedEnd[0] = occupiedEnd[1] = 40;
+        return;
+    }
+
+    uint8_t line = (address & 0x40) ? 1 : 0;
+    uint8_t column = address & 0x3F;
+    if (occupiedStart[line] >= occupiedEnd[line])
+    {
+        occupiedStart[line] = column;
+        occupiedEnd[line] = column + 1;
+    }
+    else if (column < occupiedStart[line])
+    {
+        occupiedStart[line] = column;
+    }
+    else if (column >= occupiedEnd[line])
+    {
+        occupiedEnd[line] = column + 1;
+    }
 }
 
+void PololuHD44780Base::clearOccupied()
+{
+    occupiedStart[0] = occupiedEnd[0] = 0;
+    occupiedStart[1] = occupiedEnd[1] = 0;
+}
+
+void PololuHD44780Base::waitWhileBusy()
+{
+    // Give up eventually so that a disconnected LCD cannot hang the program.
+    // The longest commands take about 1.52 ms.
+    uint16_t start = micros();
+    while ((receive(false) & 0x80) && (uint16_t)(micros() - start) < 5000)
+    {
+    }
+
+#if POLOLU_HD44780_STATS
+    countDelay((uint16_t)(micros() - start));
+#endif
+}
+
+// Measures how long the LCD stays busy after the transfer that was just sent.
+uint16_t PololuHD44780Base::measureBusyTime()
+{
+    uint16_t start = micros();
+    uint16_t elapsed;
+    do
+    {
+        elapsed = micros() - start;
+    }
+    while ((receive(false) & 0x80) && elapsed < 5000);
+    return elapsed;
+}
+
+// Adds a margin to a measured execution time.  The measurements can be a few
+// microseconds short because they start when send() returns, and micros() only
+// has a resolution of 4 us on some boards.
+static uint16_t withMargin(uint16_t time)
+{
+    return time + time / 4 + 8;
+}
+
+bool PololuHD44780Base::calibrateTiming()
+{
+    init();
+    if (!busyFlagUsed) { return false; }
+
+    // The measurements have to be done synchronously.
+    PololuHD44780Queue * savedQueue = queue;
+    if (queue) { drainQueue(); }
+    queue = NULL;
+
+    PololuHD44780Timing measured(0, 0, 0, 0);
+
+    // In framebuffer mode, clear() only clears the framebuffer, so send the
+    // command ourselves and clear the framebuffer to match.
+    clearFields();
+    if (framebuffer) { framebufferClear(); }
+    sendCommand(LCD_CLEAR, timing.clear);
+    measured.clear = measureBusyTime();
+    home();
+    measured.home = measureBusyTime();
+
+    // Take the longest of several measurements for the short instructions.
+    // Writing spaces to the cleared screen does not change what it shows.
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        sendCommand(0b00001000 | sentDisplayControl);
+        uint16_t time = measureBusyTime();
+        if (time > measured.command) { measured.command = time; }
+
+        sendData(' ');
+        time = measureBusyTime();
+        if (time > measured.data) { measured.data = time; }
+    }
+    sendCommand(0x80);
+
+    queue = savedQueue;
+
+    if (measured.clear >= 5000 || measured.home >= 5000 ||
+        measured.command >= 5000 || measured.data >= 5000)
+    {
+        // The LCD never stopped being busy.
+        return false;
+    }
+
+    timing.command = withMargin(measured.command);
+    timing.data = withMargin(measured.data);
+    timing.clear = withMargin(measured.clear);
+    timing.home = withMargin(measured.home);
+    return true;
+}
+
+#if POLOLU_HD44780_STATS
+void PololuHD44780Base::countTransfer(uint8_t data, bool rsValue, bool only4bit)
+{
+    PololuHD44780Stats::ApiStats & api = stats.api[statsApi];
+    if (rsValue)
+    {
+        stats.dataBytes++;
+        api.dataBytes++;
+    }
+    else
+    {
+        stats.commands++;
+        api.commands++;
+        if (data == LCD_CLEAR) { stats.clears++; }
+        else if ((data & 0xFE) == 0x02) { stats.homes++; }
+    }
+    stats.busCycles += (only4bit || eightBitInterface()) ? 1 : 2;
+}
+
+void PololuHD44780Base::countDelay(uint32_t time)
+{
+    stats.delayTime += time;
+    stats.api[statsApi].delayTime += time;
+}
+#endif
+
 size_t PololuHD44780Base::write(uint8_t data)
 {
+    POLOLU_HD44780_STATS_API(write);
+    if (geometry.columns)
+    {
+        return write(&data, 1);
+    }
+
+    if (framebuffer)
+    {
+        framebufferWrite(data);
+        return 1;
+    }
+
     sendData(data);
     return 1;
 }
 
 size_t PololuHD44780Base::write(const uint8_t * buffer, size_t length)
 {
+    POLOLU_HD44780_STATS_API(write);
     size_t n = length;
-    while (n--)
+    while (n)
     {
-        sendData(*buffer++);
+        // Send the characters that fit on the current row, and if they fill
+        // it, remember where the next character should go.
+        uint8_t next;
+        size_t run = wrapRun(next);
+        bool filled = run && run <= n;
+        if (!filled) { run = n; }
+
+        if (framebuffer)
+        {
+            for (size_t i = 0; i < run; i++)
+            {
+                framebufferWrite(buffer[i]);
+            }
+        }
+        else
+        {
+            sendDataBlock(buffer, run);
+        }
+
+        if (filled) { wrapAddress = next; }
+        buffer += run;
+        n -= run;
     }
     return length;
 }
 
-void PololuHD44780Base::clear()
+// Moves to the next row if the last character written filled a row.  Then
+// returns how many characters fit in the rest of the row (or the half of the
+// row, if it is split) in the direction the address counter moves, and sets
+// next to the address of the character that should come after them.  Returns
+// 0 if the geometry is unknown, auto-scrolling is enabled, or the cursor is
+// not on the screen.
+size_t PololuHD44780Base::wrapRun(uint8_t & next)
 {
-    sendCommand(LCD_CLEAR);
+    if (geometry.columns == 0 || (entryMode & 0b01)) { return 0; }
+
+    if (wrapAddress != 0xFF)
+    {
+        if (framebuffer)
+        {
+            framebuffer->index = ddramIndex(wrapAddress);
+        }
+        else if (address != wrapAddress)
+        {
+            sendCommand(0x80 | wrapAddress);
+        }
+        wrapAddress = 0xFF;
+    }
+
+    uint8_t a;
+    if (framebuffer)
+    {
+        a = ddramAddress(framebuffer->index);
+    }
+    else
+    {
+        if (addressInCgram || address == 0xFF) { return 0; }
+        a = address;
+    }
+
+    const uint8_t columns = geometry.columns;
+    const uint8_t rows = geometry.rows;
+    const uint8_t split = geometry.splitColumn;
+    const bool forward = entryMode & 0b10;
+    for (uint8_t y = 0; y < rows; y++)
+    {
+        // Check each half of the row separately, since their addresses are
+        // not necessarily consecutive.
+        for (uint8_t half = 0; half < (split ? 2 : 1); half++)
+        {
+            uint8_t x0 = half ? split : 0;
+            uint8_t x1 = (split && !half) ? split : columns;
+            uint8_t start = geometry.address(x0, y);
+            if (a < start || a >= start + (x1 - x0)) { continue; }
 
-    // It's not clear how long this command takes because it doesn't say in
-    // Table 6 of the HD44780 datasheet.  A good guess is that it takes 1.52 ms,
-    // since the Return Home command does.
-    _delay_us(2000);
+            uint8_t x = x0 + (a - start);
+            if (forward)
+            {
+                if (x1 < columns) { next = geometry.address(x1, y); }
+                else { next = geometry.address(0, (y + 1) % rows); }
+                return x1 - x;
+            }
+            else
+            {
+                if (x0 > 0) { next = geometry.address(x0 - 1, y); }
+                else { next = geometry.address(columns - 1, (y + rows - 1) % rows); }
+                return x - x0 + 1;
+            }
+        }
+    }
+    return 0;
 }
 
-void PololuHD44780Base::gotoXY(uint8_t x, uint8_t y)
+size_t PololuHD44780Base::print(const __FlashStringHelper * string)
 {
-    // Each entry is the RAM address of a line, with its most
-    // significant bit set for convenience.
-    const uint8_t line_mem[] = {0x80, 0xC0, 0x94, 0xD4};
+    POLOLU_HD44780_STATS_API(write);
+    const char * p = (const char *)string;
+    uint8_t chunk[16];
+    size_t n = 0;
+    while (true)
+    {
+        uint8_t length = 0;
+        while (length < sizeof(chunk))
+        {
+            uint8_t c = pgm_read_byte(p++);
+            if (c == 0) { break; }
+            chunk[length++] = c;
+        }
+        write(chunk, length);
+        n += length;
+        if (length < sizeof(chunk)) { return n; }
+    }
+}
 
-    // Avoid out-of-bounds array access.
-    if (y > 3) { y = 3; }
+void PololuHD44780Base::clear()
+{
+    POLOLU_HD44780_STATS_API(clear);
+    clearFields();
 
-    sendCommand(line_mem[y] + x);
+    if (framebuffer)
+    {
+        framebufferClear();
+        return;
+    }
 
-    // This could take up to 37 us according to Table 6 of the HD44780 datasheet.
-    _delay_us(37);
+    // It's not clear how long this command takes on an HD44780 because it
+    // doesn't say in Table 6 of the datasheet, so the default timing uses a
+    // conservative guess.  See PololuHD44780Timing.
+    sendCommand(LCD_CLEAR, timing.clear);
 }
 
-void PololuHD44780Base::loadCustomCharacter(const uint8_t * picture, uint8_t number)
+void PololuHD44780Base::setGeometry(const PololuHD44780Geometry & geometry)
 {
-    uint8_t address = number * 8;
+    this->geometry = geometry;
+    wrapAddress = 0xFF;
+}
 
-    for(uint8_t i = 0; i < 8; i++)
-    {
-        // Set CG RAM address.
-        sendCommand(0b01000000 | (address + i));
+void PololuHD44780Base::gotoXY(uint8_t x, uint8_t y)
+{
+    POLOLU_HD44780_STATS_API(gotoXY);
+    // Avoid out-of-bounds array access.
+    if (y >= geometry.rows) { y = geometry.rows - 1; }
+
+    uint8_t a = geometry.address(x, y) & 0x7F;
+    wrapAddress = 0xFF;
 
-        // Write character data.
-        sendData(pgm_read_byte(picture + i));
+    if (framebuffer)
+    {
+        framebuffer->index = ddramIndex(a);
+        return;
     }
+
+    if (a == address) { return; }
+    sendCommand(0x80 | a);
 }
 
-void PololuHD44780Base::loadCustomCharacterFromRam(const uint8_t * picture, uint8_t number)
+void PololuHD44780Base::loadCgram(const uint8_t * pictures, uint8_t first,
+    uint8_t count, bool fromProgmem)
 {
-    uint8_t address = number * 8;
+    POLOLU_HD44780_STATS_API(customCharacter);
+#if POLOLU_HD44780_STATS
+    stats.cgramUploads += count;
+#endif
+
+    uint8_t savedAddress = address;
+    uint8_t savedWrapAddress = wrapAddress;
+    uint8_t start = first * 8;
+    uint8_t length = count * 8;
 
-    for(uint8_t i = 0; i < 8; i++)
+    // The LCD moves its address counter after each byte in the direction
+    // specified by the I/D bit, so if it is moving down we start at the end
+    // and send the pattern backwards.
+    bool backwards = !(entryMode & 0b10);
+
+    // Set CG RAM address.
+    sendCommand(0b01000000 | ((backwards ? start + length - 1 : start) & 0x3F));
+
+    // Write character data, one character at a time so we can copy it to RAM
+    // and put it in the right order.
+    uint8_t picture[8];
+    for (uint8_t c = 0; c < count; c++)
     {
-        // Set CG RAM address.
-        sendCommand(0b01000000 | (address + i));
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            const uint8_t * p = pictures +
+                (backwards ? length - 1 - (c * 8 + i) : c * 8 + i);
+            picture[i] = fromProgmem ? pgm_read_byte(p) : *p;
+        }
+        sendDataBlock(picture, 8);
+    }
 
-        // Write character data.
-        sendData(picture[i]);
+    // Go back to where we were in DD RAM, without forgetting a pending wrap
+    // to the next row.
+    if (savedAddress != 0xFF)
+    {
+        sendCommand(0x80 | savedAddress);
     }
+    wrapAddress = savedWrapAddress;
 }
 
 void PololuHD44780Base::setDisplayControl(uint8_t displayControl)
 {
-    sendCommand(0b00001000 | displayControl);
+    POLOLU_HD44780_STATS_API(displayControl);
     this->displayControl = displayControl;
+    if (updateDepth) { return; }
+    sendDisplayControl();
+}
+
+void PololuHD44780Base::sendDisplayControl()
+{
+    POLOLU_HD44780_STATS_API(displayControl);
+    sendCommand(0b00001000 | displayControl);
+    sentDisplayControl = displayControl;
 }
 
 void PololuHD44780Base::cursorSolid()
@@ -181,24 +864,169 @@ void PololuHD44780Base::blink()
 
 void PololuHD44780Base::scrollDisplayLeft()
 {
+    POLOLU_HD44780_STATS_API(scroll);
     sendCommand(0b00011000);
 }
 
 void PololuHD44780Base::scrollDisplayRight()
 {
+    POLOLU_HD44780_STATS_API(scroll);
     sendCommand(0b00011100);
 }
 
 void PololuHD44780Base::home()
 {
-    sendCommand(0b00000010);
-    _delay_us(1600); // needs to be at least 1.52 ms
+    POLOLU_HD44780_STATS_API(home);
+    sendCommand(0b00000010, timing.home);
+
+    if (framebuffer) { framebuffer->index = 0; }
+}
+
+// Returns the number of scroll commands needed to undo the display shift.
+uint8_t PololuHD44780Base::unshiftCommands()
+{
+    return shift <= 20 ? shift : 40 - shift;
+}
+
+// Scrolls the display back to its default position, taking the shortest way.
+void PololuHD44780Base::unshift()
+{
+    while (shift != 0)
+    {
+        if (shift <= 20) { scrollDisplayRight(); } else { scrollDisplayLeft(); }
+    }
+}
+
+uint16_t PololuHD44780Base::fastHome()
+{
+    POLOLU_HD44780_STATS_API(home);
+    uint16_t start = micros();
+    init();
+
+    // Scrolling back and then setting the address takes one more command than
+    // undoing the shift.
+    if ((uint16_t)(unshiftCommands() + 1) * timing.command >= timing.home)
+    {
+        home();
+        return micros() - start;
+    }
+
+    unshift();
+    if (framebuffer)
+    {
+        framebuffer->index = 0;
+        wrapAddress = 0xFF;
+    }
+    else if (address != 0)
+    {
+        sendCommand(0x80);
+    }
+
+    return micros() - start;
+}
+
+uint16_t PololuHD44780Base::fastClear()
+{
+    POLOLU_HD44780_STATS_API(clear);
+    uint16_t start = micros();
+    init();
+
+    clearFields();
+
+    if (framebuffer)
+    {
+        framebufferClear();
+        return micros() - start;
+    }
+
+    // Add up the time needed to overwrite the occupied characters, set the
+    // entry mode, undo the display shift, and go to the upper left corner.
+    uint8_t commands = unshiftCommands() + 1;
+    uint8_t characters = 0;
+    for (uint8_t line = 0; line < 2; line++)
+    {
+        if (occupiedStart[line] < occupiedEnd[line])
+        {
+            commands++;
+            characters += occupiedEnd[line] - occupiedStart[line];
+        }
+    }
+    if (entryMode != 0b10) { commands++; }
+    if (entryMode & 0b01) { commands++; }
+
+    uint32_t overwriteTime = (uint32_t)commands * timing.command +
+        (uint32_t)characters * timing.data;
+    if (overwriteTime >= timing.clear)
+    {
+        clear();
+        return micros() - start;
+    }
+
+    // Data must be written from left to right, without auto-scrolling.
+    uint8_t savedEntryMode = entryMode;
+    if (entryMode != 0b10) { setEntryMode(0b10); }
+
+    uint8_t spaces[8];
+    memset(spaces, ' ', sizeof(spaces));
+    for (uint8_t line = 0; line < 2; line++)
+    {
+        uint8_t column = occupiedStart[line];
+        if (column >= occupiedEnd[line]) { continue; }
+        sendCommand(0x80 | (line ? 0x40 : 0) | column);
+        while (column < occupiedEnd[line])
+        {
+            uint8_t length = occupiedEnd[line] - column;
+            if (length > sizeof(spaces)) { length = sizeof(spaces); }
+            sendDataBlock(spaces, length);
+            column += length;
+        }
+    }
+    clearOccupied();
+
+    // Like the "Clear display" command, leave the I/D bit set.
+    if (savedEntryMode & 0b01) { setEntryMode(0b11); }
+
+    unshift();
+    if (address != 0) { sendCommand(0x80); }
+
+    return micros() - start;
 }
 
 void PololuHD44780Base::setEntryMode(uint8_t entryMode)
 {
-    sendCommand(0b00000100 | entryMode);
+    POLOLU_HD44780_STATS_API(entryMode);
     this->entryMode = entryMode;
+    if (updateDepth)
+    {
+        // The command is sent before the next data transfer, if it is still
+        // needed then.
+        return;
+    }
+    sendEntryMode();
+}
+
+void PololuHD44780Base::sendEntryMode()
+{
+    POLOLU_HD44780_STATS_API(entryMode);
+    sendCommand(0b00000100 | entryMode);
+    sentEntryMode = entryMode;
+}
+
+void PololuHD44780Base::beginUpdate()
+{
+    // Initialize first so that the initialization sequence does not replace
+    // the settings made during the update.
+    init();
+    updateDepth++;
+}
+
+void PololuHD44780Base::endUpdate()
+{
+    if (updateDepth == 0 || --updateDepth != 0) { return; }
+
+    flush();
+    if (entryMode != sentEntryMode) { sendEntryMode(); }
+    if (displayControl != sentDisplayControl) { sendDisplayControl(); }
 }
 
 void PololuHD44780Base::leftToRight()
@@ -220,3 +1048,338 @@ void PololuHD44780Base::noAutoscroll()
 {
     setEntryMode(entryMode & ~0b01);
 }
+
+void PololuHD44780Base::enableFramebuffer(PololuHD44780Framebuffer & framebuffer)
+{
+    this->framebuffer = NULL;
+    clear();
+
+    memset(framebuffer.cells, ' ', sizeof(framebuffer.cells));
+    memset(framebuffer.shown, ' ', sizeof(framebuffer.shown));
+    framebuffer.index = 0;
+    this->framebuffer = &framebuffer;
+}
+
+void PololuHD44780Base::disableFramebuffer()
+{
+    POLOLU_HD44780_STATS_API(flush);
+    if (!framebuffer) { return; }
+
+    flush();
+
+    // Flushing does not necessarily leave the LCD's address counter where the
+    // next character should go, so set it explicitly.
+    sendAddress(framebuffer->index);
+    framebuffer = NULL;
+}
+
+void PololuHD44780Base::framebufferWrite(uint8_t data)
+{
+    uint8_t i = framebuffer->index;
+    framebuffer->cells[i] = data;
+
+    // Move to the next location the same way the LCD's address counter would.
+    if (entryMode & 0b10)
+    {
+        i = (i + 1) % PololuHD44780Framebuffer::size;
+    }
+    else
+    {
+        i = (i + PololuHD44780Framebuffer::size - 1) % PololuHD44780Framebuffer::size;
+    }
+    framebuffer->index = i;
+}
+
+void PololuHD44780Base::framebufferClear()
+{
+    wrapAddress = 0xFF;
+    memset(framebuffer->cells, ' ', sizeof(framebuffer->cells));
+    framebuffer->index = 0;
+}
+
+void PololuHD44780Base::sendAddress(uint8_t index)
+{
+    uint8_t a = ddramAddress(index);
+    if (address != a) { sendCommand(0x80 | a); }
+}
+
+void PololuHD44780Base::flush()
+{
+    POLOLU_HD44780_STATS_API(flush);
+    if (!framebuffer) { return; }
+
+    uint8_t * cells = framebuffer->cells;
+    uint8_t * shown = framebuffer->shown;
+    const uint8_t size = PololuHD44780Framebuffer::size;
+    uint8_t savedEntryMode = entryMode;
+    bool sending = false;
+
+    uint8_t i = 0;
+    while (i < size)
+    {
+        if (cells[i] == shown[i]) { i++; continue; }
+
+        if (!sending)
+        {
+            // Data must be written from left to right, without auto-scrolling.
+            if (entryMode != 0b10) { setEntryMode(0b10); }
+            sending = true;
+        }
+
+        // Find the end of this run of changed characters.  Rewriting one
+        // unchanged character costs as much as an address command, so we
+        // include single unchanged characters in the run to keep it going.
+        // Because the LCD's address counter goes from 0x27 to 0x40, the run
+        // can continue from the first line to the second.
+        uint8_t start = i;
+        uint8_t end = i + 1;
+        while (end < size && (cells[end] != shown[end] ||
+            (end + 1 < size && cells[end + 1] != shown[end + 1])))
+        {
+            end++;
+        }
+
+        // If the address counter is just before the run, it is cheaper to
+        // rewrite that character than to set the address.
+        if (start > 0 && address == ddramAddress(start - 1)) { start--; }
+
+        sendAddress(start);
+        sendDataBlock(cells + start, end - start);
+        memcpy(shown + start, cells + start, end - start);
+        i = end;
+    }
+
+    if (!sending) { return; }
+
+    if (entryMode != savedEntryMode) { setEntryMode(savedEntryMode); }
+
+    // If the cursor is visible, put it back where the next character goes.
+    if (displayControl & 0b011)
+    {
+        sendAddress(framebuffer->index);
+    }
+}
+
+void PololuHD44780Base::enableAsync(PololuHD44780Queue & queue)
+{
+    init();
+    this->queue = &queue;
+}
+
+void PololuHD44780Base::disableAsync()
+{
+    if (!queue) { return; }
+    drainQueue();
+    queue = NULL;
+}
+
+void PololuHD44780Base::enqueue(uint8_t data, uint8_t flags, uint16_t delayTime)
+{
+    uint8_t tail = queue->tail;
+    uint8_t next = tail + 1;
+    if (next == queue->size) { next = 0; }
+
+    if (next == queue->head)
+    {
+        queue->overflows++;
+#if POLOLU_HD44780_STATS
+        uint16_t start = micros();
+#endif
+        while (next == queue->head) { poll(); }
+#if POLOLU_HD44780_STATS
+        countDelay((uint16_t)(micros() - start));
+#endif
+    }
+
+    PololuHD44780Queue::Entry & entry = queue->entries[tail];
+    entry.data = data;
+    entry.flags = flags;
+    entry.delayTime = delayTime;
+
+    // Make sure the entry is written before poll() can see it.
+    asm volatile("" ::: "memory");
+    queue->tail = next;
+}
+
+bool PololuHD44780Base::readyToSend()
+{
+    if (busyFlagUsed)
+    {
+        return !(receive(false) & 0x80);
+    }
+    return (uint32_t)(micros() - queue->lastTime) >= queue->lastDelay;
+}
+
+bool PololuHD44780Base::poll()
+{
+    if (!queue) { return true; }
+    if (queue->polling) { return false; }
+    queue->polling = true;
+
+    uint8_t head = queue->head;
+    while (head != queue->tail && readyToSend())
+    {
+        PololuHD44780Queue::Entry & entry = queue->entries[head];
+        send(entry.data, entry.flags & PololuHD44780Queue::rsFlag,
+            entry.flags & PololuHD44780Queue::only4bitFlag);
+        queue->lastTime = micros();
+        queue->lastDelay = entry.delayTime;
+
+        head++;
+        if (head == queue->size) { head = 0; }
+        queue->head = head;
+    }
+
+    queue->polling = false;
+    return head == queue->tail;
+}
+
+void PololuHD44780Base::drainQueue()
+{
+    if (!queue) { return; }
+
+    while (!poll()) { }
+
+    // Wait for the last transfer to finish too.
+    while (!readyToSend()) { }
+}
+
+void PololuHD44780Base::addField(PololuHD44780Field & field)
+{
+    removeField(field);
+    field.next = fields;
+    fields = &field;
+}
+
+void PololuHD44780Base::removeField(PololuHD44780Field & field)
+{
+    PololuHD44780Field ** p = &fields;
+    while (*p)
+    {
+        if (*p == &field)
+        {
+            *p = field.next;
+            field.next = NULL;
+            return;
+        }
+        p = &(*p)->next;
+    }
+}
+
+// Records that the fields we know about are blank because the LCD is being
+// cleared.
+void PololuHD44780Base::clearFields()
+{
+    for (PololuHD44780Field * field = fields; field; field = field->next)
+    {
+        memset(field->shown, ' ', field->fieldWidth);
+        field->known = true;
+    }
+}
+
+void PololuHD44780Base::printField(PololuHD44780Field & field, const char * text)
+{
+    uint8_t length = 0;
+    while (length < field.fieldWidth && text[length]) { length++; }
+    renderField(field, (const uint8_t *)text, length);
+}
+
+void PololuHD44780Base::printField(PololuHD44780Field & field,
+    const __FlashStringHelper * text)
+{
+    const char * p = (const char *)text;
+    uint8_t buffer[PololuHD44780Field::maxWidth];
+    uint8_t length = 0;
+    while (length < field.fieldWidth)
+    {
+        uint8_t c = pgm_read_byte(p++);
+        if (c == 0) { break; }
+        buffer[length++] = c;
+    }
+    renderField(field, buffer, length);
+}
+
+void PololuHD44780Base::printFieldNumber(PololuHD44780Field & field,
+    unsigned long magnitude, bool negative, uint8_t decimals)
+{
+    if (decimals > 9) { decimals = 9; }
+
+    // Write the digits from right to left.
+    uint8_t buffer[24];
+    uint8_t i = sizeof(buffer);
+    uint8_t digits = 0;
+    do
+    {
+        if (decimals && digits == decimals) { buffer[--i] = '.'; }
+        buffer[--i] = '0' + magnitude % 10;
+        magnitude /= 10;
+        digits++;
+    }
+    while (magnitude || digits <= decimals);
+    if (negative) { buffer[--i] = '-'; }
+
+    uint8_t length = sizeof(buffer) - i;
+    if (length > field.fieldWidth)
+    {
+        memset(buffer, '*', field.fieldWidth);
+        renderField(field, buffer, field.fieldWidth);
+        return;
+    }
+    renderField(field, buffer + i, length);
+}
+
+void PololuHD44780Base::renderField(PololuHD44780Field & field,
+    const uint8_t * text, uint8_t length)
+{
+    POLOLU_HD44780_STATS_API(field);
+
+    const uint8_t width = field.fieldWidth;
+    uint8_t * shown = field.shown;
+
+    uint8_t cells[PololuHD44780Field::maxWidth];
+    uint8_t textStart = 0;
+    if (field.alignment == PololuHD44780Field::alignRight)
+    {
+        textStart = width - length;
+    }
+    memset(cells, ' ', width);
+    memcpy(cells + textStart, text, length);
+
+    // If we do not know what the field is showing, send all of it.
+    bool all = !field.known;
+
+    uint8_t savedEntryMode = entryMode;
+    bool sending = false;
+
+    uint8_t i = 0;
+    while (i < width)
+    {
+        if (!all && cells[i] == shown[i]) { i++; continue; }
+
+        if (!sending)
+        {
+            // Data must be written from left to right, without auto-scrolling.
+            if (entryMode != 0b10) { setEntryMode(0b10); }
+            sending = true;
+        }
+
+        // Find the end of this run of changed characters, including single
+        // unchanged characters the same way flush() does.
+        uint8_t start = i;
+        uint8_t end = i + 1;
+        while (end < width && (all || cells[end] != shown[end] ||
+            (end + 1 < width && cells[end + 1] != shown[end + 1])))
+        {
+            end++;
+        }
+
+        gotoXY(field.x + start, field.y);
+        write(cells + start, end - start);
+        i = end;
+    }
+
+    memcpy(shown, cells, width);
+    field.known = true;
+
+    if (sending && entryMode != savedEntryMode) { setEntryMode(savedEntryMode); }
+}
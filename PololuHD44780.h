@@ -11,7 +11,539 @@
 
 #pragma once
 #include <Arduino.h>
+
+#ifdef __AVR__
 #include <util/delay.h>
+#else
+// Other architectures do not have avr-libc's _delay_us, so we use the
+// equivalent Arduino function.
+#define _delay_us(us) delayMicroseconds(us)
+#endif
+
+/*! Set this to 1 to make PololuHD44780Base keep a PololuHD44780Stats object
+ * with counts of everything it sends to the LCD.  It must have the same value
+ * everywhere the library is compiled, so it should be defined with a compiler
+ * option (for example, `-DPOLOLU_HD44780_STATS=1` in the `build_flags` of a
+ * PlatformIO project), not in a sketch.  When it is 0 (the default), the
+ * statistics code is not compiled at all. */
+#ifndef POLOLU_HD44780_STATS
+#define POLOLU_HD44780_STATS 0
+#endif
+
+/*! \brief RAM copy of the LCD's display data.
+ *
+ * An object of this class holds a copy of all 80 bytes of the HD44780's
+ * display data RAM (DDRAM) along with a copy of what was last sent to the LCD,
+ * so it uses 161 bytes of RAM.  To use it, allocate one (usually as a
+ * global variable) and pass it to PololuHD44780Base::enableFramebuffer().
+ *
+ * The contents of this class are managed by PololuHD44780Base and are not
+ * meant to be accessed directly. */
+class PololuHD44780Framebuffer
+{
+    friend class PololuHD44780Base;
+
+    /* The number of bytes of display data RAM: two lines of 40 columns. */
+    static const uint8_t size = 80;
+
+    /* The character stored at each DDRAM location.  Index 0 through 39 are
+     * DDRAM addresses 0x00 through 0x27 (the first line), and index 40
+     * through 79 are DDRAM addresses 0x40 through 0x67 (the second line). */
+    uint8_t cells[size];
+
+    /* The characters that the LCD is actually displaying, in the same order
+     * as cells.  flush() sends each entry of cells that differs from this. */
+    uint8_t shown[size];
+
+    /* The index in cells where the next character will be written. */
+    uint8_t index;
+};
+
+/*! \brief Queue of LCD transfers used by PololuHD44780Base's asynchronous
+ * mode.
+ *
+ * You cannot create an object of this class directly.  Instead, create a
+ * PololuHD44780QueueBuffer, which includes storage for the queue entries, and
+ * pass it to PololuHD44780Base::enableAsync(). */
+class PololuHD44780Queue
+{
+public:
+    /*! Returns the number of transfers currently waiting in the queue. */
+    uint8_t length() const
+    {
+        uint8_t h = head, t = tail;
+        return t >= h ? t - h : size - h + t;
+    }
+
+    /*! Returns the maximum number of transfers that can be waiting in the
+     * queue. */
+    uint8_t capacity() const
+    {
+        return size - 1;
+    }
+
+    /*! Returns the number of times a transfer was added to the queue while it
+     * was full.  Each time this happens, the function adding the transfer has
+     * to wait for room, which means the queue is too small for the amount of
+     * data being sent or poll() is not being called often enough. */
+    uint16_t overflowCount() const
+    {
+        return overflows;
+    }
+
+    /*! Resets the count returned by overflowCount() to zero. */
+    void resetOverflowCount()
+    {
+        overflows = 0;
+    }
+
+protected:
+
+    struct Entry
+    {
+        uint8_t data;
+        uint8_t flags;
+        uint16_t delayTime;
+    };
+
+    PololuHD44780Queue(Entry * entries, uint8_t size)
+    {
+        this->entries = entries;
+        this->size = size;
+        head = tail = 0;
+        overflows = 0;
+        polling = false;
+        lastTime = 0;
+        lastDelay = 0;
+    }
+
+private:
+    friend class PololuHD44780Base;
+
+    static const uint8_t rsFlag = 1;
+    static const uint8_t only4bitFlag = 2;
+
+    Entry * entries;
+
+    /* The number of entries, which is one more than the capacity so we can
+     * tell a full queue from an empty one. */
+    uint8_t size;
+
+    /* The entry that will be sent next.  Only modified by poll(). */
+    volatile uint8_t head;
+
+    /* The entry that will be filled next.  Only modified when adding. */
+    volatile uint8_t tail;
+
+    volatile uint16_t overflows;
+
+    /* True while poll() is running, so it can be called from an interrupt
+     * and from the main loop without the two calls interfering. */
+    volatile bool polling;
+
+    /* The value of micros() when the last transfer was sent, and how long
+     * it takes to execute.  The time is kept in full so that a queue that
+     * was idle for more than 65 ms does not look busy again. */
+    uint32_t lastTime;
+    uint16_t lastDelay;
+};
+
+/*! \brief Queue of LCD transfers with storage for a fixed number of entries.
+ *
+ * Each entry takes 4 bytes of RAM.
+ *
+ * @tparam maxLength The maximum number of transfers that can be waiting,
+ *   from 1 to 254. */
+template <uint8_t maxLength> class PololuHD44780QueueBuffer :
+    public PololuHD44780Queue
+{
+    // The queue keeps one entry empty and indexes entries with a uint8_t.
+    static_assert(maxLength > 0 && maxLength < 255,
+        "PololuHD44780QueueBuffer length must be from 1 to 254");
+
+public:
+    PololuHD44780QueueBuffer() : PololuHD44780Queue(storage, maxLength + 1)
+    {
+    }
+
+private:
+    Entry storage[maxLength + 1];
+};
+
+/*! \brief A fixed-width area of the screen that shows a number or some
+ * text, updated with PololuHD44780Base::printField().
+ *
+ * You cannot create an object of this class directly.  Instead, create a
+ * PololuHD44780FieldBuffer, which includes storage for the characters the
+ * field is showing.
+ *
+ * Example:
+ *
+ * ~~~{.cpp}
+ * PololuHD44780FieldBuffer<5> speed(10, 1, PololuHD44780Field::alignRight);
+ *
+ * void setup()
+ * {
+ *     lcd.addField(speed);
+ * }
+ *
+ * void loop()
+ * {
+ *     lcd.printField(speed, readSpeed(), 1);  // shows 12.3, for example
+ * }
+ * ~~~
+ */
+class PololuHD44780Field
+{
+public:
+    /*! Values for the alignment of the text in a field. */
+    enum Alignment
+    {
+        alignLeft,   //!< Text starts at the left edge of the field.
+        alignRight,  //!< Text ends at the right edge of the field.
+    };
+
+    /*! The maximum width of a field. */
+    static const uint8_t maxWidth = 40;
+
+    /*! Returns the number of characters in the field. */
+    uint8_t width() const
+    {
+        return fieldWidth;
+    }
+
+    /*! Makes the next call to PololuHD44780Base::printField() send every
+     * character of the field, instead of only the ones that changed.  Call
+     * this if something else might have written over the field. */
+    void invalidate()
+    {
+        known = false;
+    }
+
+protected:
+
+    PololuHD44780Field(uint8_t * shown, uint8_t width, uint8_t x, uint8_t y,
+        uint8_t alignment)
+    {
+        this->shown = shown;
+        this->fieldWidth = width > maxWidth ? maxWidth : width;
+        this->x = x;
+        this->y = y;
+        this->alignment = alignment;
+        known = false;
+        next = NULL;
+    }
+
+private:
+    friend class PololuHD44780Base;
+
+    /* The characters the LCD is showing in the field, if known is true. */
+    uint8_t * shown;
+
+    uint8_t fieldWidth;
+    uint8_t x, y;
+    uint8_t alignment;
+    bool known;
+
+    /* The next field in the list of fields added to the LCD. */
+    PololuHD44780Field * next;
+};
+
+/*! \brief A PololuHD44780Field with storage for a fixed number of
+ * characters.
+ *
+ * Each field takes 9 bytes of RAM plus one byte per character.
+ *
+ * @tparam fieldSize The number of characters in the field. */
+template <uint8_t fieldSize> class PololuHD44780FieldBuffer :
+    public PololuHD44780Field
+{
+public:
+    /*! Creates a new field.
+     *
+     * @param x The column of the leftmost character of the field.
+     * @param y The row of the field.
+     * @param alignment PololuHD44780Field::alignLeft or
+     *   PololuHD44780Field::alignRight. */
+    PololuHD44780FieldBuffer(uint8_t x, uint8_t y,
+        uint8_t alignment = alignLeft)
+        : PololuHD44780Field(storage, fieldSize, x, y, alignment)
+    {
+    }
+
+private:
+    uint8_t storage[fieldSize];
+};
+
+/*! \brief How long an LCD controller takes to execute its instructions.
+ *
+ * PololuHD44780Base uses these times when it cannot read the LCD's busy flag,
+ * delaying after each transfer until the LCD should be ready for the next one.
+ * The default times come from the HD44780 datasheet, which assumes the
+ * slowest oscillator frequency the controller allows, so many LCDs are
+ * actually faster.  You can pick a profile for your controller with
+ * PololuHD44780Base::setTiming(), or measure your LCD with
+ * PololuHD44780Base::calibrateTiming().
+ *
+ * The delays during initialization and the width of the pulses on E are not
+ * included, since they are already as short as the datasheets allow. */
+class PololuHD44780Timing
+{
+public:
+    /*! Creates a timing profile with the default times, the same as
+     * hd44780(). */
+    PololuHD44780Timing()
+    {
+        command = 37;
+        data = 37;
+        clear = 2000;
+        home = 1600;
+    }
+
+    /*! Creates a timing profile with the specified times, in microseconds. */
+    PololuHD44780Timing(uint16_t command, uint16_t data, uint16_t clear,
+        uint16_t home)
+    {
+        this->command = command;
+        this->data = data;
+        this->clear = clear;
+        this->home = home;
+    }
+
+    /*! Returns the times from Table 6 of the Hitachi HD44780 datasheet.  The
+     * datasheet does not say how long "Clear display" takes, so we use 2000
+     * microseconds to be safe. */
+    static PololuHD44780Timing hd44780()
+    {
+        return PololuHD44780Timing();
+    }
+
+    /*! Returns the times from the Sitronix ST7066U datasheet, which lists
+     * 1.52&nbsp;ms for "Clear display" and "Return home".  The Sunplus
+     * SPLC780D datasheet lists the same times, so this profile works for LCDs
+     * with that controller too. */
+    static PololuHD44780Timing st7066u()
+    {
+        return PololuHD44780Timing(37, 37, 1600, 1600);
+    }
+
+    /*! Microseconds needed by most commands. */
+    uint16_t command;
+
+    /*! Microseconds needed to write a byte of data. */
+    uint16_t data;
+
+    /*! Microseconds needed by the "Clear display" command. */
+    uint16_t clear;
+
+    /*! Microseconds needed by the "Return home" command. */
+    uint16_t home;
+};
+
+/*! \brief Counts of the transfers and delays performed by PololuHD44780Base.
+ *
+ * PololuHD44780Base only keeps these statistics if #POLOLU_HD44780_STATS is
+ * 1.  You can read them with PololuHD44780Base::getStats() and reset them
+ * with PololuHD44780Base::resetStats().
+ *
+ * Besides the totals, the commands, data bytes, and delays are attributed to
+ * the public function that caused them, which is useful for finding out which
+ * part of a program is keeping the LCD busy.  When one of those functions
+ * calls another (for example, when print() causes the LCD to be initialized),
+ * everything is attributed to the outermost one, except for the
+ * initialization sequence, which is always attributed to #init. */
+class PololuHD44780Stats
+{
+public:
+    /*! The groups of public functions that the statistics are broken down
+     * by. */
+    enum Api
+    {
+        other,            //!< Anything not listed below.
+        init,             //!< The initialization sequence.
+        write,            //!< write() and print().
+        gotoXY,           //!< gotoXY() and setCursor().
+        clear,            //!< clear() and fastClear().
+        home,             //!< home() and fastHome().
+        customCharacter,  //!< The functions that load custom characters.
+        displayControl,   //!< display() and the cursor functions.
+        entryMode,        //!< leftToRight(), autoscroll(), and similar.
+        scroll,           //!< scrollDisplayLeft() and scrollDisplayRight().
+        command,          //!< command().
+        flush,            //!< flush() and disableFramebuffer().
+        field,            //!< printField().
+        apiCount,         //!< The number of groups.
+    };
+
+    /*! Statistics for one group of public functions. */
+    struct ApiStats
+    {
+        uint16_t calls;       //!< Number of calls.
+        uint16_t commands;    //!< Commands sent.
+        uint16_t dataBytes;   //!< Data bytes sent.
+        uint32_t delayTime;   //!< Microseconds spent waiting for the LCD.
+    };
+
+    /*! Total number of commands sent. */
+    uint32_t commands;
+
+    /*! Total number of data bytes sent. */
+    uint32_t dataBytes;
+
+    /*! Total number of pulses on the E line. */
+    uint32_t busCycles;
+
+    /*! Total number of microseconds spent delaying or polling the busy flag
+     * while waiting for the LCD to execute a transfer. */
+    uint32_t delayTime;
+
+    /*! Number of custom characters loaded. */
+    uint16_t cgramUploads;
+
+    /*! Number of "Clear display" commands sent. */
+    uint16_t clears;
+
+    /*! Number of "Return home" commands sent. */
+    uint16_t homes;
+
+    /*! Statistics for each group of public functions, indexed by Api. */
+    ApiStats api[apiCount];
+
+    /*! Sets all the statistics to zero. */
+    void reset()
+    {
+        memset(this, 0, sizeof(*this));
+    }
+};
+
+/*! \brief Description of how the characters on an LCD are laid out.
+ *
+ * An HD44780 has 80 bytes of display data RAM (DDRAM), but LCD modules show
+ * different parts of it depending on their size.  This class records which
+ * DDRAM address each character on the screen comes from, so that
+ * PololuHD44780Base::gotoXY() can find it and PololuHD44780Base::write()
+ * can move on to the next row when it reaches the end of a row.  To use it,
+ * pass one to PololuHD44780Base::setGeometry().
+ *
+ * For example:
+ *
+ * ~~~{.cpp}
+ * lcd.setGeometry(PololuHD44780Geometry(16, 2));
+ * ~~~
+ *
+ * The constructor works for all the common layouts: 8&times;1, 8&times;2,
+ * 16&times;1 (use `split` if the right half is at DDRAM address 0x40, as on
+ * most 16&times;1 modules), 16&times;2, 16&times;4, 20&times;2, 20&times;4,
+ * 24&times;2, and 40&times;2.  For other layouts, you can change the members
+ * after constructing the object. */
+class PololuHD44780Geometry
+{
+public:
+    /*! Creates a geometry with the default layout: 4 rows starting at DDRAM
+     * addresses 0x00, 0x40, 0x14, and 0x54 (the same as a 20&times;4 LCD),
+     * with an unknown number of columns.  With this geometry, gotoXY() accepts
+     * any column and write() never moves to the next row, which is how the
+     * library behaves if setGeometry() is never called. */
+    PololuHD44780Geometry()
+    {
+        set(0, 4, false);
+        rowAddress[2] = 0x14;
+        rowAddress[3] = 0x54;
+    }
+
+    /*! Creates a geometry for an LCD with the specified number of columns and
+     * rows.
+     *
+     * The first two rows start at DDRAM addresses 0x00 and 0x40, and the
+     * third and fourth rows (if any) continue those two lines, starting at
+     * addresses `columns` and 0x40 + `columns`.
+     *
+     * @param columns The number of characters in each row, up to 40 (or 80
+     *   for LCDs with one row).  Larger values are reduced to the limit.
+     * @param rows The number of rows, from 1 to 4.  Other values are moved
+     *   into that range.
+     * @param split True if the right half of each row is stored on the second
+     *   line of DDRAM, starting at address 0x40.  This is usually the case
+     *   for 16&times;1 LCDs. */
+    PololuHD44780Geometry(uint8_t columns, uint8_t rows, bool split = false)
+    {
+        set(columns, rows, split);
+    }
+
+    /*! Returns the DDRAM address of the character at the specified column and
+     * row, which must be on the screen unless #columns is 0. */
+    uint8_t address(uint8_t x, uint8_t y) const
+    {
+        if (splitColumn && x >= splitColumn)
+        {
+            return rowAddress[y] + 0x40 + x - splitColumn;
+        }
+        return rowAddress[y] + x;
+    }
+
+    /*! The number of characters in each row, or 0 if unknown. */
+    uint8_t columns;
+
+    /*! The number of rows, from 1 to 4. */
+    uint8_t rows;
+
+    /*! The DDRAM address of the leftmost character in each row. */
+    uint8_t rowAddress[4];
+
+    /*! The first column that is stored at DDRAM address 0x40 plus the row
+     * address instead of following the columns to its left, or 0 if the rows
+     * are not split. */
+    uint8_t splitColumn;
+
+private:
+    void set(uint8_t columns, uint8_t rows, bool split)
+    {
+        // Keep the rows within rowAddress and the columns within DDRAM.
+        if (rows < 1) { rows = 1; }
+        if (rows > 4) { rows = 4; }
+        uint8_t maxColumns = rows == 1 ? 80 : 40;
+        if (columns > maxColumns) { columns = maxColumns; }
+
+        this->columns = columns;
+        this->rows = rows;
+        splitColumn = split ? columns / 2 : 0;
+        rowAddress[0] = 0x00;
+        rowAddress[1] = 0x40;
+        rowAddress[2] = columns;
+        rowAddress[3] = 0x40 + columns;
+    }
+};
+
+/*! \brief Interface for objects that record every transfer to the LCD.
+ *
+ * Pass an object of a class that implements this interface to
+ * PololuHD44780Base::enableTrace(), and record() will be called for every
+ * byte or nibble the LCD object sends, in the order they are sent.  This is
+ * meant for finding out what your program sends to the LCD and where it
+ * wastes time.  PololuHD44780Trace.h has a ring buffer that stores the
+ * transfers and an analyzer that looks for unnecessary ones. */
+class PololuHD44780TraceSink
+{
+public:
+    /*! Records one transfer.
+     *
+     * @param data The byte sent, or the nibble if only4bits is true.
+     * @param rsValue True for data, false for a command.
+     * @param only4bits True if only the lower 4 bits were sent, which
+     *   only happens during initialization.
+     * @param delayTime How many microseconds the LCD is given to execute
+     *   the transfer.  If the LCD object reads the busy flag, it waits for
+     *   the flag instead, so this is an upper limit. */
+    virtual void record(uint8_t data, bool rsValue, bool only4bits,
+        uint16_t delayTime) = 0;
+};
+
+#if POLOLU_HD44780_STATS
+#define POLOLU_HD44780_STATS_API(name) \
+    StatsScope statsScope(*this, PololuHD44780Stats::name)
+#else
+#define POLOLU_HD44780_STATS_API(name)
+#endif
 
 /*! \brief General class for handling the HD44780 protocol.
  *
@@ -52,6 +584,35 @@
  * X coordinates of the columns displayed, from left to right, will be 35, 36,
  * 37, 38, 39, 0, 1, and 2.
  *
+ * ## Framebuffer mode ##
+ *
+ * Normally, every character written to the LCD is sent to it immediately.  If
+ * you pass a PololuHD44780Framebuffer object to enableFramebuffer(), then
+ * write(), gotoXY(), and clear() only update that RAM copy of the display, and
+ * nothing is sent to the LCD until you call flush().  The flush() function
+ * only sends the characters that actually changed, so redrawing a whole screen
+ * where only a few characters are different is much faster than in the normal
+ * mode.
+ *
+ * In framebuffer mode, clear() does not reset the scroll position and
+ * autoscroll() has no effect on the characters written.  All other functions,
+ * such as the scrolling, cursor, and custom character functions, still take
+ * effect immediately.
+ *
+ * ## Display geometry ##
+ *
+ * By default, gotoXY() assumes the rows are laid out like a 20&times;4 LCD,
+ * and write() just stores characters at consecutive DDRAM addresses, so text
+ * that is too long for a row ends up in RAM that is not displayed or on a row
+ * further down the screen.  If you tell the library the size of your LCD by
+ * passing a PololuHD44780Geometry to setGeometry(), then gotoXY() uses the
+ * right address for each row and write() continues on the next row (or goes
+ * back to the top row after the bottom one) when it reaches the end of a row.
+ * Because the LCD's address counter only needs to be moved when another
+ * character is written, this adds at most one command per row of text.
+ *
+ * Wrapping is disabled while auto-scrolling is on.  In right-to-left mode,
+ * write() continues at the end of the row above.
  */
 class PololuHD44780Base : public Print
 {
@@ -63,12 +624,13 @@ public:
      * successfully.  This is the first step of initializing the LCD. */
     virtual void initPins() = 0;
 
-    /*! Initialize the LCD if it has not already been initialized. */
+    /*! Initialize the LCD if it has not already been initialized.  If
+     * beginAsync() was called and the initialization is not done yet, this
+     * finishes it. */
     void init()
     {
-        if (!initialized)
+        if (initStage != initDone)
         {
-            initialized = true;
             init2();
         }
     }
@@ -79,10 +641,48 @@ public:
      *  state. */
     void reinitialize()
     {
-        initialized = true;
+        initStage = 0;
         init2();
     }
 
+    /*! Starts initializing the LCD without waiting.
+     *
+     * Initializing the LCD takes more than 6&nbsp;ms, most of which is spent
+     * waiting for it to execute the first few commands.  Normally that
+     * happens automatically, during the first function call that uses the
+     * LCD.  Instead, you can call this function and then call initStep()
+     * repeatedly (for example, from your main loop while other parts of your
+     * program start up).  Each call to initStep() sends the next part of the
+     * initialization sequence if enough time has passed since the previous
+     * part, and returns right away otherwise.
+     *
+     * If any other function that uses the LCD is called before the
+     * initialization is done, it finishes the initialization first, the same
+     * way it would have without beginAsync().
+     *
+     * Example:
+     *
+     * ~~~{.cpp}
+     * void setup()
+     * {
+     *     lcd.beginAsync();
+     *     while (!lcd.initStep())
+     *     {
+     *         // Do something else.
+     *     }
+     * }
+     * ~~~
+     */
+    void beginAsync();
+
+    /*! Performs the next part of the initialization started by beginAsync(),
+     * if it is time to do so.  See beginAsync().
+     *
+     * This function uses `micros()` to measure the time between steps.
+     *
+     * @return True if the LCD is initialized and ready to use. */
+    bool initStep();
+
     /*! Sends data or commands to the LCD.
      *
      * The initPins() function will always be called before the first time this
@@ -101,26 +701,108 @@ public:
      *   the lower 4 bits of the data. */
     virtual void send(uint8_t data, bool rsValue, bool only4bits) = 0;
 
+    /*! Returns true if the LCD is connected with an 8-bit interface (DB0
+     * through DB7), or false if it uses a 4-bit interface (DB4 through DB7).
+     *
+     * PololuHD44780Base uses this to pick the right initialization sequence.
+     * The default implementation returns false, so subclasses for 8-bit
+     * interfaces need to define it. */
+    virtual bool eightBitInterface()
+    {
+        return false;
+    }
+
+    /*! Returns the minimum number of microseconds between the start of a
+     * call to send() and the first falling edge on E that it causes.
+     *
+     * PololuHD44780Base subtracts this from the delay it would otherwise
+     * perform after each transfer, since the next transfer cannot reach the
+     * LCD any sooner than that.  This way, subclasses that talk to the LCD
+     * over a slow bus (such as I2C) do not have to wait for the LCD twice.
+     * The default implementation returns 0. */
+    virtual uint16_t sendTime()
+    {
+        return 0;
+    }
+
+    /*! Sends a series of bytes to the LCD, all with the same RS value.
+     *
+     * PololuHD44780Base calls this instead of send() when it has several
+     * bytes of data to send at once, such as when writing a string or loading
+     * custom characters, so that subclasses can send them more efficiently
+     * (for example, in a single bus transaction).
+     *
+     * An override must leave at least getTiming().data microseconds between
+     * the falling edges on E for consecutive bytes.  That time is not fixed:
+     * setTiming() and calibrateTiming() can change it, so an override that
+     * relies on its bus being slow enough must compare the time the bus
+     * takes per byte with getTiming().data on each call, and call
+     * waitForData() after each byte when the bus is faster.
+     *
+     * The default implementation calls send() and waitForData() for each
+     * byte.
+     *
+     * @param data A pointer to the bytes to send, in RAM.
+     * @param length The number of bytes to send.
+     * @param rsValue True to drive the RS pin high, false to drive it low. */
+    virtual void sendBlock(const uint8_t * data, size_t length, bool rsValue);
+
+protected:
+
+    /*! Waits long enough for the LCD to process a byte of data that was just
+     * sent, taking sendTime() into account.  This is meant to be used in
+     * implementations of sendBlock(). */
+    void waitForData()
+    {
+        delayAfterSend(timing.data);
+    }
+
+    /*! Reads a byte from the LCD.
+     *
+     * This function is optional.  Subclasses that have the LCD's R/W line
+     * connected can define it, and then PololuHD44780Base will poll the LCD's
+     * busy flag to determine when each command has finished instead of always
+     * delaying for the worst-case execution time.
+     *
+     * @param rsValue False to read the busy flag (bit 7) and address counter
+     *   (bits 0-6), true to read data from the LCD's RAM.
+     * @return The byte read, or -1 if reading is not supported.  The default
+     *   implementation returns -1. */
+    virtual int16_t receive(bool rsValue)
+    {
+        (void)rsValue;
+        return -1;
+    }
+
 private:
 
-    void sendAndDelay(uint8_t data, bool rsValue, bool only4bit);
+    void sendAndDelay(uint8_t data, bool rsValue, bool only4bit,
+        uint16_t delayTime);
+
+    void delayAfterSend(uint16_t delayTime);
 
-    /*! Sends an 8-bit command to the LCD. */
+    /*! Sends several bytes of data from RAM to the LCD. */
+    void sendDataBlock(const uint8_t * data, size_t length);
+
+    /*! Sends an 8-bit command to the LCD that takes the usual amount of time
+     * to execute. */
     void sendCommand(uint8_t cmd)
     {
-        sendAndDelay(cmd, false, false);
+        sendAndDelay(cmd, false, false, timing.command);
     }
 
-    /*! Sends a 4-bit command to the LCD. */
-    void sendCommand4Bit(uint8_t cmd)
+    /*! Sends an 8-bit command to the LCD.
+     *
+     * @param delayTime How many microseconds the command takes to execute. */
+    void sendCommand(uint8_t cmd, uint16_t delayTime)
     {
-        sendAndDelay(cmd, false, true);
+        sendAndDelay(cmd, false, false, delayTime);
     }
 
     /*! Sends 8 bits of a data to the LCD. */
     void sendData(uint8_t data)
     {
-        sendAndDelay(data, true, false);
+        sendAndDelay(data, true, false, timing.data);
     }
 
 public:
@@ -130,14 +812,51 @@ public:
     void clear();
 
     /*! Defines a custom character.
+     *
+     * After the character is defined, the cursor is put back where it was, so
+     * you can keep printing without calling gotoXY().
+     *
      * @param picture A pointer to the character dot pattern, in program space.
      * @param number A number between 0 and 7. */
-    void loadCustomCharacter(const uint8_t * picture, uint8_t number);
+    void loadCustomCharacter(const uint8_t * picture, uint8_t number)
+    {
+        loadCgram(picture, number, 1, true);
+    }
 
     /*! Defines a custom character from RAM.
      * @param picture A pointer to the character dot pattern, in RAM.
      * @param number A number between 0 and 7. */
-    void loadCustomCharacterFromRam(const uint8_t * picture, uint8_t number);
+    void loadCustomCharacterFromRam(const uint8_t * picture, uint8_t number)
+    {
+        loadCgram(picture, number, 1, false);
+    }
+
+    /*! Defines several consecutive custom characters at once.
+     *
+     * This sends a single "Set CGRAM address" command followed by 8 bytes for
+     * each character, so it is faster than calling loadCustomCharacter()
+     * multiple times.  After the characters are defined, the cursor is put
+     * back where it was.
+     *
+     * @param pictures A pointer to the dot patterns, in program space, with 8
+     *   bytes for each character.
+     * @param first The number of the first character to define, between 0
+     *   and 7.
+     * @param count The number of characters to define.  The first character
+     *   plus the count must not exceed 8. */
+    void loadCustomCharacters(const uint8_t * pictures, uint8_t first = 0,
+        uint8_t count = 8)
+    {
+        loadCgram(pictures, first, count, true);
+    }
+
+    /*! Defines several consecutive custom characters at once, from RAM.
+     * See loadCustomCharacters() for details. */
+    void loadCustomCharactersFromRam(const uint8_t * pictures,
+        uint8_t first = 0, uint8_t count = 8)
+    {
+        loadCgram(pictures, first, count, false);
+    }
 
     /*! This overload of loadCustomCharacter is only provided for compatibility
      * with OrangutanLCD; a lot of Orangutan code defines an array of chars for
@@ -157,14 +876,70 @@ public:
     /*! Change the location of the cursor.  The cursor (whether visible or invisible),
      *  is the place where the next character written to the LCD will be displayed.
      *
+     * This class keeps track of the LCD's address counter, so if the cursor
+     * is already at the specified location (for example, because the last
+     * character written was just to the left of it), this function does not
+     * need to send anything to the LCD.
+     *
      * Note that the scrolling features of the LCD change the correspondence
      * between the `x` parameter and the physical column that the data is
      * displayed on.  See the "LCD scrolling" section above for more information.
      *
+     * The rows are found using the geometry passed to setGeometry().  See the
+     * "Display geometry" section above.
+     *
      * @param x The number of the column to go to, with 0 being the leftmost column.
      * @param y The number of the row to go to, with 0 being the top row. */
     void gotoXY(uint8_t x, uint8_t y);
 
+    /*! Sets how long the library assumes the LCD takes to execute each
+     * instruction.  See PololuHD44780Timing.
+     *
+     * The timing is copied, so the argument does not need to remain valid. */
+    void setTiming(const PololuHD44780Timing & timing)
+    {
+        this->timing = timing;
+    }
+
+    /*! Returns the timing passed to setTiming() or measured by
+     * calibrateTiming(). */
+    const PololuHD44780Timing & getTiming() const
+    {
+        return timing;
+    }
+
+    /*! Measures how long the LCD takes to execute each kind of instruction
+     * by reading its busy flag, and uses those times (plus a margin of 25%
+     * and a few microseconds) as the timing for this object.
+     *
+     * This only works if the subclass can read from the LCD, as
+     * PololuHD44780RW can.  Since such subclasses normally use the busy flag
+     * instead of delays anyway, this is mainly useful for measuring one LCD
+     * and then passing getTiming() to setTiming() for other LCDs of the same
+     * type that do not have their R/W lines connected.  Subclasses whose
+     * busy flag does not come from the LCD, such as
+     * PololuHD44780SharedBusLcd, override this to return false.
+     *
+     * This function clears the screen.
+     *
+     * @return True if the measurements succeeded, or false if the LCD's busy
+     *   flag cannot be read, in which case the timing is not changed. */
+    virtual bool calibrateTiming();
+
+    /*! Tells the library how the characters on the LCD are laid out.  See
+     * the "Display geometry" section above.
+     *
+     * The geometry is copied, so the argument does not need to remain
+     * valid. */
+    void setGeometry(const PololuHD44780Geometry & geometry);
+
+    /*! Returns the geometry passed to setGeometry(), or the default geometry
+     * if setGeometry() has not been called. */
+    const PololuHD44780Geometry & getGeometry() const
+    {
+        return geometry;
+    }
+
     /*! Changes the location of the cursor.  This is just a wrapper around
      * gotoXY provided for compaitibility with the LiquidCrystal library. */
     void setCursor(uint8_t col, uint8_t row)
@@ -265,9 +1040,37 @@ public:
      *
      * This command takes about 1600 microseconds, so it would be faster to
      * instead call scrollDisplayLeft() or scrollDisplayRight() the appropriate
-     * number of times and then call gotoXY(0, 0). */
+     * number of times and then call gotoXY(0, 0).  fastHome() does that for
+     * you. */
     void home();
 
+    /*! Does the same thing as home(), using whichever sequence of commands is
+     * fastest.
+     *
+     * This class keeps track of how far the display has been scrolled, so
+     * unless it has been scrolled by more than about 20 columns, this function
+     * sends scrollDisplayLeft() or scrollDisplayRight() commands and a "Set
+     * DDRAM address" command instead of the slow "Return home" command.
+     *
+     * @return The number of microseconds this function took. */
+    uint16_t fastHome();
+
+    /*! Does the same thing as clear(), using whichever sequence of commands is
+     * fastest.
+     *
+     * This class keeps track of which parts of each line of the LCD's RAM have
+     * had anything other than a space written to them since the last time the
+     * LCD was cleared.  If overwriting those parts with spaces, resetting the
+     * scrolling position, and moving the cursor takes less time than the
+     * "Clear display" command (about 2000 microseconds), this function does
+     * that instead.  For example, clearing a 16&times;2 screen whose lines
+     * are full takes about 1300 microseconds this way.
+     *
+     * Like clear(), this function leaves the LCD in left-to-right mode.
+     *
+     * @return The number of microseconds this function took. */
+    uint16_t fastClear();
+
     /*! Puts the LCD into left-to-right mode: the cursor will shift to the right
      *  after any character is written.  This is the default behavior. */
     void leftToRight();
@@ -293,6 +1096,7 @@ public:
      * with the LiquidCrystal library. */
     void command(uint8_t cmd)
     {
+        POLOLU_HD44780_STATS_API(command);
         sendCommand(cmd);
     }
 
@@ -307,31 +1111,362 @@ public:
      *  null termination character. */
     virtual size_t write(const uint8_t * buffer, size_t size);
 
-    // This allows us to easily call overrides of write that are
+    /*! Writes a string from program space to the LCD.  This is called by
+     * `print(F("..."))`, and sends the string in blocks instead of one
+     * character at a time. */
+    size_t print(const __FlashStringHelper * string);
+
+    // This allows us to easily call overrides of write and print that are
     // defined in Print.
     using Print::write;
+    using Print::print;
+
+    /*! Enables framebuffer mode.  See the "Framebuffer mode" section above.
+     *
+     * This clears the LCD and the framebuffer, so both start out blank.
+     *
+     * @param framebuffer A framebuffer object, which must remain valid until
+     *   disableFramebuffer() is called. */
+    void enableFramebuffer(PololuHD44780Framebuffer & framebuffer);
+
+    /*! Flushes the framebuffer and then disables framebuffer mode, so that
+     * characters are sent directly to the LCD again. */
+    void disableFramebuffer();
+
+    /*! Sends all the characters in the framebuffer that have changed since the
+     * last flush to the LCD.
+     *
+     * Runs of changed characters are sent with a single "Set DDRAM address"
+     * command, and unchanged characters between two nearby runs are resent
+     * when that is cheaper than another address command.  This function does
+     * nothing if framebuffer mode is not enabled. */
+    void flush();
+
+    /*! Starts a group of changes that should reach the LCD together.
+     *
+     * Until the matching call to endUpdate(), the functions that change the
+     * display and cursor settings (display(), noCursor(), cursorBlinking(),
+     * and so on) and the entry mode (leftToRight(), autoscroll(), and so on)
+     * only remember the new settings.  Only the final settings are sent, at
+     * most one command for each, and nothing is sent for settings that end up
+     * the same as before.  For example, this sends just the clear command:
+     *
+     * ~~~{.cpp}
+     * lcd.beginUpdate();
+     * lcd.noDisplay();
+     * lcd.clear();
+     * lcd.noCursor();
+     * lcd.display();
+     * lcd.endUpdate();
+     * ~~~
+     *
+     * Characters are still written in order, and a changed entry mode is
+     * sent before the first character that depends on it.  To also have the
+     * characters sent in address order with as few "Set DDRAM address"
+     * commands as possible, enable framebuffer mode: endUpdate() then calls
+     * flush().
+     *
+     * Calls to beginUpdate() can be nested; only the outermost endUpdate()
+     * sends anything. */
+    void beginUpdate();
+
+    /*! Ends a group of changes started by beginUpdate(), and sends the
+     * settings that changed. */
+    void endUpdate();
+
+    /*! Enables asynchronous mode.
+     *
+     * In asynchronous mode, the functions that send commands or data to the
+     * LCD add them to the specified queue and return without waiting.  The
+     * transfers are actually sent by poll(), which sends each one only after
+     * the previous one has had time to finish.  If the queue is full, the
+     * function adding to it calls poll() itself until there is room.
+     *
+     * This function initializes the LCD first if needed, which takes a few
+     * milliseconds.
+     *
+     * @param queue The queue to use, which must remain valid until
+     *   disableAsync() is called. */
+    void enableAsync(PololuHD44780Queue & queue);
+
+    /*! Sends all the transfers waiting in the queue and then disables
+     * asynchronous mode. */
+    void disableAsync();
+
+    /*! Sends the transfers in the queue that are ready to be sent, without
+     * waiting for the ones that are not.  In asynchronous mode, this should be
+     * called frequently, either from your main loop or from a timer interrupt.
+     *
+     * @return True if the queue is empty. */
+    bool poll();
+
+    /*! Waits until all the transfers in the queue have been sent. */
+    void drainQueue();
+
+    /*! Adds a field to the list of fields that this object keeps track of.
+     * Fields in the list know that they are blank after the LCD is cleared,
+     * so printField() does not have to send their spaces again.  Using
+     * printField() on a field that was not added works too.
+     *
+     * @param field The field, which must remain valid until removeField() is
+     *   called. */
+    void addField(PololuHD44780Field & field);
+
+    /*! Removes a field added by addField(). */
+    void removeField(PololuHD44780Field & field);
+
+    /*! Shows some text in a field.
+     *
+     * The text is padded with spaces according to the field's alignment, and
+     * only the characters that are different from what the field was showing
+     * are sent to the LCD.  Runs of changed characters are sent with a single
+     * "Set DDRAM address" command, the same way flush() sends them.  If the
+     * text is longer than the field, only the first characters are shown.
+     *
+     * @param field The field.
+     * @param text A null-terminated string in RAM. */
+    void printField(PololuHD44780Field & field, const char * text);
+
+    /*! Shows a string from program space in a field, for example
+     * `lcd.printField(field, F("OK"))`. */
+    void printField(PololuHD44780Field & field,
+        const __FlashStringHelper * text);
+
+    /*! Shows a number in a field.
+     *
+     * This does the same thing as printField(PololuHD44780Field &, const char *)
+     * with the number in decimal.  If the number does not fit, the field is
+     * filled with asterisks.
+     *
+     * @param field The field.
+     * @param value The number to show.
+     * @param decimals If not zero, the number is shown as a fixed-point
+     *   number with this many digits after the decimal point, from 1 to 9.
+     *   For example, a value of 1234 with 2 decimals is shown as 12.34. */
+    void printField(PololuHD44780Field & field, long value,
+        uint8_t decimals = 0)
+    {
+        printFieldNumber(field, value < 0 ? -(unsigned long)value : value,
+            value < 0, decimals);
+    }
+
+    /*! Shows a number in a field.  See
+     * printField(PololuHD44780Field &, long, uint8_t). */
+    void printField(PololuHD44780Field & field, unsigned long value,
+        uint8_t decimals = 0)
+    {
+        printFieldNumber(field, value, false, decimals);
+    }
+
+    /*! Shows a number in a field.  See
+     * printField(PololuHD44780Field &, long, uint8_t). */
+    void printField(PololuHD44780Field & field, int value,
+        uint8_t decimals = 0)
+    {
+        printField(field, (long)value, decimals);
+    }
+
+    /*! Shows a number in a field.  See
+     * printField(PololuHD44780Field &, long, uint8_t). */
+    void printField(PololuHD44780Field & field, unsigned int value,
+        uint8_t decimals = 0)
+    {
+        printField(field, (unsigned long)value, decimals);
+    }
+
+    /*! Starts sending every transfer to the specified trace sink, which must
+     * remain valid until disableTrace() is called.  Transfers are recorded
+     * when they are sent, or when they are added to the queue in
+     * asynchronous mode. */
+    void enableTrace(PololuHD44780TraceSink & sink)
+    {
+        trace = &sink;
+    }
+
+    /*! Stops recording transfers. */
+    void disableTrace()
+    {
+        trace = NULL;
+    }
+
+#if POLOLU_HD44780_STATS
+    /*! Returns the statistics collected since the last call to resetStats().
+     * This is only available if #POLOLU_HD44780_STATS is 1. */
+    const PololuHD44780Stats & getStats() const
+    {
+        return stats;
+    }
+
+    /*! Sets all the statistics to zero.  This is only available if
+     * #POLOLU_HD44780_STATS is 1. */
+    void resetStats()
+    {
+        stats.reset();
+    }
+#endif
 
 private:
-    bool initialized;
+    static const uint8_t initDone = 0xFF;
+
+    /* 0 if the LCD has not been initialized, initDone if it has, or the
+     * number of the next step of the initialization sequence. */
+    uint8_t initStage;
+
+    /* The value of micros() when the last initialization step was performed,
+     * and how long to wait before the next one. */
+    uint16_t initTime;
+    uint16_t initDelay;
+
+    void initStart();
+    uint16_t initNext();
+    uint16_t initTransfer(uint8_t data, bool only4bit, uint16_t delayTime);
+
+    /* True if receive() is supported and we are using the busy flag instead of
+     * fixed delays. */
+    bool busyFlagUsed;
+
+    void waitWhileBusy();
+
+    /* The queue being used, or NULL if asynchronous mode is disabled. */
+    PololuHD44780Queue * queue;
+
+    void enqueue(uint8_t data, uint8_t flags, uint16_t delayTime);
+    bool readyToSend();
+
+    /* The DDRAM address that the LCD's address counter is pointing to, or
+     * 0xFF if we do not know (for example, after writing to CGRAM). */
+    uint8_t address;
+
+    /* True if the address counter is pointing to CGRAM instead of DDRAM. */
+    bool addressInCgram;
+
+    /* How many columns the display has been shifted to the left, from 0 to
+     * 39. */
+    uint8_t shift;
+
+    /* For each of the two lines of DDRAM, the columns from
+     * occupiedStart[line] up to but not including occupiedEnd[line] contain
+     * every character other than a space that has been written since the LCD
+     * was last cleared. */
+    uint8_t occupiedStart[2];
+    uint8_t occupiedEnd[2];
+
+    /* How the characters on the screen are laid out. */
+    PololuHD44780Geometry geometry;
+
+    /* How long the LCD takes to execute instructions. */
+    PololuHD44780Timing timing;
+
+    uint16_t measureBusyTime();
+
+    /* The DDRAM address that the next character written should go to, if the
+     * last data written filled a row, or 0xFF otherwise.  Cleared by the
+     * commands that change the address counter (clear, home, set DDRAM or
+     * CGRAM address, and cursor shift) and by gotoXY(); display shifts and
+     * changes to the display control or entry mode leave it alone. */
+    uint8_t wrapAddress;
+
+    size_t wrapRun(uint8_t & next);
+
+    void trackTransfer(uint8_t data, bool rsValue, bool only4bit);
+    void trackData(uint8_t data);
+    void clearOccupied();
+    uint8_t unshiftCommands();
+    void unshift();
+
+    void loadCgram(const uint8_t * pictures, uint8_t first, uint8_t count,
+        bool fromProgmem);
+
+    /* The framebuffer being used, or NULL if framebuffer mode is disabled. */
+    PololuHD44780Framebuffer * framebuffer;
+
+    void framebufferWrite(uint8_t data);
+    void framebufferClear();
+    void sendAddress(uint8_t index);
+
+    /* The first field in the list of fields added by addField(). */
+    PololuHD44780Field * fields;
+
+    void printFieldNumber(PololuHD44780Field & field, unsigned long magnitude,
+        bool negative, uint8_t decimals);
+    void renderField(PololuHD44780Field & field, const uint8_t * text,
+        uint8_t length);
+    void clearFields();
+
+    PololuHD44780TraceSink * trace;
+
+    void traceTransfer(uint8_t data, bool rsValue, bool only4bit,
+        uint16_t delayTime)
+    {
+        if (trace) { trace->record(data, rsValue, only4bit, delayTime); }
+    }
 
     /* The lower three bits of this store the arguments to the
-     * last "Display on/off control" HD44780 command that we sent.
+     * last "Display on/off control" HD44780 command that we sent, or that
+     * we will send at the end of the current update.
      * bit 2: D: Whether the display is on.
      * bit 1: C: Whether the cursor is shown.
      * bit 0: B: Whether the cursor is blinking. */
     uint8_t displayControl;
 
     /* The lower two bits of this variable store the arguments to the
-     * last "Entry mode set" HD44780 command that we sent.
+     * last "Entry mode set" HD44780 command that we sent, or that we will
+     * send before the next data transfer or at the end of the current update.
      * bit 1: I/D: 0 for moving the cursor to the left after data is written,
      *        1 for moving the cursor to the right.
      * bit 0: 1 for autoscrolling. */
     uint8_t entryMode;
 
+    /* The settings the LCD actually has.  These only differ from
+     * displayControl and entryMode between beginUpdate() and endUpdate(). */
+    uint8_t sentDisplayControl;
+    uint8_t sentEntryMode;
+
+    /* The number of calls to beginUpdate() without a matching endUpdate(). */
+    uint8_t updateDepth;
+
     void setEntryMode(uint8_t entryMode);
     void setDisplayControl(uint8_t displayControl);
+    void sendEntryMode();
+    void sendDisplayControl();
 
     void init2();
+
+#if POLOLU_HD44780_STATS
+    PololuHD44780Stats stats;
+
+    /* The group of public functions currently running, which the transfers
+     * and delays are attributed to. */
+    uint8_t statsApi;
+
+    void countTransfer(uint8_t data, bool rsValue, bool only4bit);
+    void countDelay(uint32_t time);
+
+    /* Sets statsApi for the lifetime of the object, unless a public function
+     * that was called earlier already set it. */
+    class StatsScope
+    {
+    public:
+        StatsScope(PololuHD44780Base & lcd, uint8_t api) : lcd(lcd)
+        {
+            saved = lcd.statsApi;
+            if (saved == PololuHD44780Stats::other)
+            {
+                lcd.statsApi = api;
+                lcd.stats.api[api].calls++;
+            }
+        }
+
+        ~StatsScope()
+        {
+            lcd.statsApi = saved;
+        }
+
+    private:
+        PololuHD44780Base & lcd;
+        uint8_t saved;
+    };
+#endif
 };
 
 /*! \brief Main class for interfacing with the HD44780 LCDs.
@@ -406,7 +1541,27 @@ public:
         sendNibble(data & 0x0F);
     }
 
-private:
+    virtual void sendBlock(const uint8_t * data, size_t length, bool rsValue)
+    {
+        // Configure the pins once for the whole block.
+        digitalWrite(rs, rsValue);
+
+        pinMode(rs, OUTPUT);
+        pinMode(db4, OUTPUT);
+        pinMode(db5, OUTPUT);
+        pinMode(db6, OUTPUT);
+        pinMode(db7, OUTPUT);
+
+        while (length--)
+        {
+            sendNibble(*data >> 4);
+            sendNibble(*data & 0x0F);
+            data++;
+            waitForData();
+        }
+    }
+
+protected:
 
     void sendNibble(uint8_t data)
     {
@@ -423,3 +1578,166 @@ private:
 
     uint8_t rs, e, db4, db5, db6, db7;
 };
+
+/*! \brief Class for interfacing with HD44780 LCDs that have their R/W line
+ * connected.
+ *
+ * This class is just like PololuHD44780, except that it also takes a pin
+ * connected to the LCD's R/W pin.  Instead of delaying for the worst-case
+ * execution time after each command, it reads the LCD's busy flag and sends
+ * the next command as soon as the LCD is ready for it, which is usually much
+ * sooner.
+ *
+ * Like the RS and DB pins, the R/W pin is reconfigured each time it is used,
+ * so it is OK to use it for other purposes as long as the LCD's E pin stays
+ * low. */
+class PololuHD44780RW : public PololuHD44780
+{
+public:
+    /*! Creates a new instance of PololuHD44780RW.
+     *
+     * @param rs The pin number for the microcontroller pin that is
+     *   connected to the RS pin of the LCD.
+     * @param rw The pin number for the microcontroller pin that is
+     *   connected to the R/W pin of the LCD.
+     * @param e The pin number for the microcontroller pin that is
+     *   connected to the E pin of the LCD.
+     * @param db4 The pin number for the microcontroller pin that is
+     *   connected to the DB4 pin of the LCD.
+     * @param db5 The pin number for the microcontroller pin that is
+     *   connected to the DB5 pin of the LCD.
+     * @param db6 The pin number for the microcontroller pin that is
+     *   connected to the DB6 pin of the LCD.
+     * @param db7 The pin number for the microcontroller pin that is
+     *   connected to the DB7 pin of the LCD.
+     */
+    PololuHD44780RW(uint8_t rs, uint8_t rw, uint8_t e, uint8_t db4,
+        uint8_t db5, uint8_t db6, uint8_t db7)
+        : PololuHD44780(rs, e, db4, db5, db6, db7)
+    {
+        this->rw = rw;
+    }
+
+    virtual void send(uint8_t data, bool rsValue, bool only4bits)
+    {
+        // R/W must be low before the data pins become outputs so that the LCD
+        // and the microcontroller never drive them at the same time.
+        digitalWrite(rw, LOW);
+        pinMode(rw, OUTPUT);
+
+        PololuHD44780::send(data, rsValue, only4bits);
+    }
+
+    virtual void sendBlock(const uint8_t * data, size_t length, bool rsValue)
+    {
+        digitalWrite(rw, LOW);
+        pinMode(rw, OUTPUT);
+
+        PololuHD44780::sendBlock(data, length, rsValue);
+    }
+
+    virtual int16_t receive(bool rsValue)
+    {
+        digitalWrite(rs, rsValue);
+        pinMode(rs, OUTPUT);
+
+        pinMode(db4, INPUT);
+        pinMode(db5, INPUT);
+        pinMode(db6, INPUT);
+        pinMode(db7, INPUT);
+
+        digitalWrite(rw, HIGH);
+        pinMode(rw, OUTPUT);
+
+        uint8_t data = receiveNibble() << 4;
+        data |= receiveNibble();
+
+        digitalWrite(rw, LOW);
+        return data;
+    }
+
+private:
+
+    uint8_t receiveNibble()
+    {
+        digitalWrite(e, HIGH);
+        _delay_us(1);  // Data is valid 360 ns after E rises.
+        uint8_t data = digitalRead(db4) << 0 |
+            digitalRead(db5) << 1 |
+            digitalRead(db6) << 2 |
+            digitalRead(db7) << 3;
+        digitalWrite(e, LOW);
+        _delay_us(1);  // Must be at least 550 ns.
+        return data;
+    }
+
+    uint8_t rw;
+};
+
+/*! \brief Class for interfacing with HD44780 LCDs using an 8-bit interface.
+ *
+ * This class is just like PololuHD44780, except that it takes eight data pins
+ * (DB0 through DB7) and sends each byte to the LCD with a single pulse on E,
+ * which is about twice as fast as the 4-bit interface. */
+class PololuHD44780EightBit : public PololuHD44780Base
+{
+public:
+    /*! Creates a new instance of PololuHD44780EightBit.
+     *
+     * @param rs The pin number for the microcontroller pin that is
+     *   connected to the RS pin of the LCD.
+     * @param e The pin number for the microcontroller pin that is
+     *   connected to the E pin of the LCD.
+     * @param db0 through db7 The pin numbers for the microcontroller pins
+     *   that are connected to the DB0 through DB7 pins of the LCD.
+     */
+    PololuHD44780EightBit(uint8_t rs, uint8_t e,
+        uint8_t db0, uint8_t db1, uint8_t db2, uint8_t db3,
+        uint8_t db4, uint8_t db5, uint8_t db6, uint8_t db7)
+    {
+        this->rs = rs;
+        this->e = e;
+        db[0] = db0;
+        db[1] = db1;
+        db[2] = db2;
+        db[3] = db3;
+        db[4] = db4;
+        db[5] = db5;
+        db[6] = db6;
+        db[7] = db7;
+    }
+
+    virtual void initPins()
+    {
+        digitalWrite(e, LOW);
+        pinMode(e, OUTPUT);
+    }
+
+    virtual void send(uint8_t data, bool rsValue, bool only4bits)
+    {
+        // A 4-bit transfer would put the data on DB4 through DB7.
+        if (only4bits) { data <<= 4; }
+
+        digitalWrite(rs, rsValue);
+        pinMode(rs, OUTPUT);
+
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            pinMode(db[i], OUTPUT);
+            digitalWrite(db[i], data >> i & 1);
+        }
+
+        digitalWrite(e, HIGH);
+        _delay_us(1);  // Must be at least 450 ns.
+        digitalWrite(e, LOW);
+        _delay_us(1);  // Must be at least 550 ns.
+    }
+
+    virtual bool eightBitInterface()
+    {
+        return true;
+    }
+
+private:
+    uint8_t rs, e, db[8];
+};
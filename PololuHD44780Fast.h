@@ -0,0 +1,175 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+/*! \file PololuHD44780Fast.h
+ *
+ * This header defines the PololuHD44780Fast class, which is a faster
+ * alternative to PololuHD44780 for AVR-based boards. */
+
+#pragma once
+#include <PololuHD44780.h>
+
+#ifndef __AVR__
+#error "PololuHD44780Fast only supports AVR microcontrollers.  Use PololuHD44780 instead."
+#endif
+
+/*! \brief Class for interfacing with HD44780 LCDs using direct port access.
+ *
+ * This class has the same constructor and pin requirements as PololuHD44780,
+ * but instead of calling `digitalWrite` and `pinMode` (which look up the port
+ * and bit for a pin every time they are called), it looks up the port
+ * registers and bit masks for each pin once, when the LCD is initialized, and
+ * writes to those registers directly after that.  If DB4 through DB7 are all
+ * on the same port, each nibble is written to the LCD with a single port
+ * write.
+ *
+ * Like PololuHD44780, this class sets the RS and DB pins to be outputs each
+ * time it uses them, so it is OK to use them for other purposes between LCD
+ * commands.  It does this by writing directly to the port's data direction
+ * register, so it is much cheaper than calling `pinMode`.  The pins should not
+ * be used for PWM output with `analogWrite` while the LCD is in use, since
+ * this class does not turn the PWM off the way `digitalWrite` would.
+ *
+ * This class only supports AVR-based boards. */
+class PololuHD44780Fast : public PololuHD44780Base
+{
+public:
+    /*! Creates a new instance of PololuHD44780Fast.  The parameters are the
+     * same as for PololuHD44780::PololuHD44780(). */
+    PololuHD44780Fast(uint8_t rs, uint8_t e, uint8_t db4, uint8_t db5,
+        uint8_t db6, uint8_t db7)
+    {
+        this->rsPin = rs;
+        this->ePin = e;
+        this->db4Pin = db4;
+        this->db5Pin = db5;
+        this->db6Pin = db6;
+        this->db7Pin = db7;
+    }
+
+    virtual void initPins()
+    {
+        // Calling digitalWrite once makes sure that PWM is disabled on each
+        // pin, so our direct port writes will take effect.
+        digitalWrite(rsPin, LOW);
+        digitalWrite(db4Pin, LOW);
+        digitalWrite(db5Pin, LOW);
+        digitalWrite(db6Pin, LOW);
+        digitalWrite(db7Pin, LOW);
+        digitalWrite(ePin, LOW);
+        pinMode(ePin, OUTPUT);
+
+        rs.init(rsPin);
+        e.init(ePin);
+        db4.init(db4Pin);
+        db5.init(db5Pin);
+        db6.init(db6Pin);
+        db7.init(db7Pin);
+
+        dataPortShared = db4.out == db5.out && db4.out == db6.out &&
+            db4.out == db7.out;
+        dataMask = db4.mask | db5.mask | db6.mask | db7.mask;
+    }
+
+    virtual void send(uint8_t data, bool rsValue, bool only4bits)
+    {
+        rs.write(rsValue);
+
+        rs.setOutput();
+        db4.setOutput();
+        db5.setOutput();
+        db6.setOutput();
+        db7.setOutput();
+
+        if (!only4bits) { sendNibble(data >> 4); }
+        sendNibble(data & 0x0F);
+    }
+
+    virtual void sendBlock(const uint8_t * data, size_t length, bool rsValue)
+    {
+        rs.write(rsValue);
+
+        rs.setOutput();
+        db4.setOutput();
+        db5.setOutput();
+        db6.setOutput();
+        db7.setOutput();
+
+        while (length--)
+        {
+            sendNibble(*data >> 4);
+            sendNibble(*data & 0x0F);
+            data++;
+            waitForData();
+        }
+    }
+
+private:
+
+    // Holds the registers and bit mask for one pin.
+    struct Pin
+    {
+        volatile uint8_t * out;
+        volatile uint8_t * mode;
+        uint8_t mask;
+
+        void init(uint8_t pin)
+        {
+            uint8_t port = digitalPinToPort(pin);
+            out = portOutputRegister(port);
+            mode = portModeRegister(port);
+            mask = digitalPinToBitMask(pin);
+        }
+
+        // Interrupts are disabled during each read-modify-write so we do not
+        // corrupt changes made to the same port by an interrupt.
+        void write(bool value)
+        {
+            uint8_t oldSREG = SREG;
+            cli();
+            if (value) { *out |= mask; } else { *out &= ~mask; }
+            SREG = oldSREG;
+        }
+
+        void setOutput()
+        {
+            uint8_t oldSREG = SREG;
+            cli();
+            *mode |= mask;
+            SREG = oldSREG;
+        }
+    };
+
+    void sendNibble(uint8_t data)
+    {
+        if (dataPortShared)
+        {
+            uint8_t bits = 0;
+            if (data & 1) { bits |= db4.mask; }
+            if (data & 2) { bits |= db5.mask; }
+            if (data & 4) { bits |= db6.mask; }
+            if (data & 8) { bits |= db7.mask; }
+
+            uint8_t oldSREG = SREG;
+            cli();
+            *db4.out = (*db4.out & ~dataMask) | bits;
+            SREG = oldSREG;
+        }
+        else
+        {
+            db4.write(data >> 0 & 1);
+            db5.write(data >> 1 & 1);
+            db6.write(data >> 2 & 1);
+            db7.write(data >> 3 & 1);
+        }
+
+        e.write(HIGH);
+        _delay_us(1);  // Must be at least 450 ns.
+        e.write(LOW);
+        _delay_us(1);  // Must be at least 550 ns.
+    }
+
+    uint8_t rsPin, ePin, db4Pin, db5Pin, db6Pin, db7Pin;
+    Pin rs, e, db4, db5, db6, db7;
+    bool dataPortShared;
+    uint8_t dataMask;
+};
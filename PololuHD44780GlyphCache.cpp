@@ -0,0 +1,105 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+#include <PololuHD44780GlyphCache.h>
+
+PololuHD44780GlyphCache::PololuHD44780GlyphCache(PololuHD44780Base & lcd,
+    uint8_t firstSlot, uint8_t slotCount)
+{
+    this->lcd = &lcd;
+    if (firstSlot > 7) { firstSlot = 7; }
+    if (slotCount > 8 - firstSlot) { slotCount = 8 - firstSlot; }
+    this->firstSlot = firstSlot;
+    this->slotCount = slotCount;
+    invalidate();
+    resetStats();
+}
+
+void PololuHD44780GlyphCache::invalidate()
+{
+    for (uint8_t i = 0; i < slotCount; i++)
+    {
+        ids[i] = noGlyph;
+        references[i] = 0;
+        order[i] = slotCount - 1 - i;  // fill the lowest slots first
+    }
+}
+
+void PololuHD44780GlyphCache::releaseAll()
+{
+    for (uint8_t i = 0; i < slotCount; i++)
+    {
+        references[i] = 0;
+    }
+}
+
+int8_t PololuHD44780GlyphCache::find(uint16_t id)
+{
+    for (uint8_t i = 0; i < slotCount; i++)
+    {
+        if (ids[i] == id) { return i; }
+    }
+    return -1;
+}
+
+// Moves a slot to the front of the order array.
+void PololuHD44780GlyphCache::touch(uint8_t slot)
+{
+    uint8_t i = 0;
+    while (order[i] != slot) { i++; }
+    while (i > 0)
+    {
+        order[i] = order[i - 1];
+        i--;
+    }
+    order[0] = slot;
+}
+
+uint8_t PololuHD44780GlyphCache::acquire(uint16_t id, const uint8_t * picture,
+    bool fromProgmem)
+{
+    int8_t slot = find(id);
+
+    if (slot >= 0)
+    {
+        hitCount++;
+    }
+    else
+    {
+        missCount++;
+
+        // Reuse the least recently used slot that is not referenced.  Empty
+        // slots are always at the end of the order.
+        for (int8_t i = slotCount - 1; i >= 0; i--)
+        {
+            if (references[order[i]] == 0)
+            {
+                slot = order[i];
+                break;
+            }
+        }
+        if (slot < 0) { return noSlot; }
+
+        if (fromProgmem)
+        {
+            lcd->loadCustomCharacter(picture, firstSlot + slot);
+        }
+        else
+        {
+            lcd->loadCustomCharacterFromRam(picture, firstSlot + slot);
+        }
+        ids[slot] = id;
+    }
+
+    if (references[slot] != 0xFF) { references[slot]++; }
+    touch(slot);
+    return firstSlot + slot;
+}
+
+void PololuHD44780GlyphCache::release(uint16_t id)
+{
+    int8_t slot = find(id);
+    if (slot >= 0 && references[slot] != 0)
+    {
+        references[slot]--;
+    }
+}
@@ -0,0 +1,123 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+/*! \file PololuHD44780GlyphCache.h
+ *
+ * This header defines the PololuHD44780GlyphCache class. */
+
+#pragma once
+#include <PololuHD44780.h>
+
+/*! \brief Manages the LCD's custom character slots for a larger set of
+ * glyphs.
+ *
+ * The HD44780 only has room for 8 custom characters.  This class lets you
+ * refer to any number of custom glyphs by a 16-bit ID of your choosing and
+ * takes care of assigning them to the LCD's custom character slots.  When you
+ * call acquire() with a glyph that is already loaded, it just returns the
+ * character code to print, without sending anything to the LCD.  Otherwise,
+ * it loads the glyph into the slot that was least recently used.
+ *
+ * Every call to acquire() increments a reference count for the glyph, and
+ * slots with a non-zero reference count are never reused.  You should call
+ * release() when a glyph is no longer displayed on the screen, since reusing
+ * its slot would change every place on the screen where it appears.
+ *
+ * Example:
+ *
+ * ~~~{.cpp}
+ * const uint8_t batteryFull[8] PROGMEM = { ... };
+ * PololuHD44780GlyphCache glyphs(lcd);
+ *
+ * lcd.write(glyphs.acquire(BATTERY_FULL_ID, batteryFull));
+ * ...
+ * glyphs.release(BATTERY_FULL_ID);
+ * ~~~
+ */
+class PololuHD44780GlyphCache
+{
+public:
+    /*! The value returned by acquire() if all of the slots are in use. */
+    static const uint8_t noSlot = 0xFF;
+
+    /*! The glyph ID that is used internally to mark empty slots.  You should
+     * not use it for your own glyphs. */
+    static const uint16_t noGlyph = 0xFFFF;
+
+    /*! Creates a new glyph cache.
+     *
+     * @param lcd The LCD to load the glyphs into.
+     * @param firstSlot The first custom character slot the cache may use.
+     * @param slotCount The number of slots the cache may use.  You can use
+     *   the slots outside of this range for your own custom characters. */
+    PololuHD44780GlyphCache(PololuHD44780Base & lcd, uint8_t firstSlot = 0,
+        uint8_t slotCount = 8);
+
+    /*! Makes sure a glyph is loaded into the LCD and returns the character
+     * code for it.
+     *
+     * @param id The ID of the glyph.
+     * @param picture A pointer to the glyph's dot pattern, in program space.
+     *   This is only used if the glyph needs to be loaded.
+     * @return The character code to write to the LCD (0 to 7), or noSlot if
+     *   every slot is holding a glyph that has not been released. */
+    uint8_t acquire(uint16_t id, const uint8_t * picture)
+    {
+        return acquire(id, picture, true);
+    }
+
+    /*! Same as acquire(), except the picture is in RAM. */
+    uint8_t acquireFromRam(uint16_t id, const uint8_t * picture)
+    {
+        return acquire(id, picture, false);
+    }
+
+    /*! Decrements the reference count of a glyph, so that its slot can be
+     * reused once the count reaches zero.  The glyph stays loaded until its
+     * slot is needed for a different glyph. */
+    void release(uint16_t id);
+
+    /*! Releases all the glyphs, without unloading them. */
+    void releaseAll();
+
+    /*! Forgets which glyphs are loaded.  Call this if something else has
+     * changed the custom characters in the cache's slots, for example after
+     * calling PololuHD44780Base::reinitialize(). */
+    void invalidate();
+
+    /*! Returns the number of calls to acquire() that found the glyph already
+     *  loaded. */
+    uint16_t hits() const { return hitCount; }
+
+    /*! Returns the number of calls to acquire() that had to load the glyph
+     *  (or could not find a slot for it). */
+    uint16_t misses() const { return missCount; }
+
+    /*! Resets the counts returned by hits() and misses() to zero. */
+    void resetStats()
+    {
+        hitCount = 0;
+        missCount = 0;
+    }
+
+private:
+    uint8_t acquire(uint16_t id, const uint8_t * picture, bool fromProgmem);
+    int8_t find(uint16_t id);
+    void touch(uint8_t slot);
+
+    PololuHD44780Base * lcd;
+    uint8_t firstSlot;
+    uint8_t slotCount;
+
+    /* The glyph ID loaded in each slot, or noGlyph. */
+    uint16_t ids[8];
+
+    /* The reference count for each slot. */
+    uint8_t references[8];
+
+    /* Slot numbers (relative to firstSlot), ordered from most recently used
+     * to least recently used. */
+    uint8_t order[8];
+
+    uint16_t hitCount;
+    uint16_t missCount;
+};
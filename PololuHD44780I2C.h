@@ -0,0 +1,169 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+/*! \file PololuHD44780I2C.h
+ *
+ * This header defines the PololuHD44780I2C class, for LCDs connected through
+ * a PCF8574 I2C I/O expander. */
+
+#pragma once
+#include <PololuHD44780.h>
+#include <Wire.h>
+
+/*! \brief Class for interfacing with HD44780 LCDs through a PCF8574 I2C
+ * "backpack".
+ *
+ * This class assumes the common backpack wiring where the expander's P0 is
+ * connected to RS, P1 to R/W, P2 to E, P3 to the backlight transistor, and P4
+ * through P7 to DB4 through DB7.
+ *
+ * Each byte sent to the LCD is transmitted to the expander in a single I2C
+ * transaction containing every output change needed for both nibbles,
+ * including the pulses on E.  When writing strings, up to 7 bytes are sent in
+ * each transaction, as long as the two I2C bytes between consecutive LCD
+ * bytes take longer than the LCD's data time (see getTiming()); otherwise
+ * each byte gets its own transaction.  At 100&nbsp;kHz and 400&nbsp;kHz, the
+ * part of each transaction before the first pulse on E takes longer than the
+ * 37&nbsp;us that most LCD commands need, so there is no extra delay after
+ * each transfer.
+ *
+ * You must call `Wire.begin()` before using the LCD.  This class does not do
+ * it, so that it will not undo any settings (such as the I2C clock speed) that
+ * you have already configured.  If you change the clock speed, also pass it
+ * to the constructor or setBusClock(), since the time each transaction takes
+ * is subtracted from the delays the LCD needs. */
+class PololuHD44780I2C : public PololuHD44780Base
+{
+public:
+    /*! Creates a new instance of PololuHD44780I2C.
+     *
+     * @param address The 7-bit I2C address of the expander.  Backpacks based
+     *   on the PCF8574 usually use 0x27, while ones based on the PCF8574A
+     *   usually use 0x3F.
+     * @param wire The I2C bus the expander is on.
+     * @param busClock The I2C clock frequency in Hz.  See setBusClock(). */
+    PololuHD44780I2C(uint8_t address = 0x27, TwoWire & wire = Wire,
+        uint32_t busClock = 400000)
+    {
+        this->address = address;
+        this->wire = &wire;
+        backlightBit = backlightMask;
+        setBusClock(busClock);
+    }
+
+    /*! Tells this object how fast the I2C bus runs, in Hz.  This does not
+     * change the bus speed: call `Wire.setClock()` for that.
+     *
+     * The default is 400000, the fastest speed the PCF8574 is commonly run
+     * at.  A value higher than the real speed only costs a little time, but
+     * a value lower than the real speed makes the library skip delays the
+     * LCD needs. */
+    void setBusClock(uint32_t busClock)
+    {
+        // E first falls at the end of the fourth byte of the transaction
+        // (counting the address), after 36 bits.  Doing the division here
+        // keeps it out of every transfer.
+        uint32_t time = busClock ? 36000000 / busClock : 0;
+        busTime = time > 0xFFFF ? 0xFFFF : time;
+
+        // Consecutive bytes in a block are 18 bits apart.
+        blockGap = busTime / 2;
+    }
+
+    /*! Turns the backlight on or off.  The backlight is on by default. */
+    void setBacklight(bool on)
+    {
+        backlightBit = on ? backlightMask : 0;
+        wire->beginTransmission(address);
+        wire->write(backlightBit);
+        wire->endTransmission();
+    }
+
+    virtual void initPins()
+    {
+        // Drive E, RS, and R/W low.
+        wire->beginTransmission(address);
+        wire->write(backlightBit);
+        wire->endTransmission();
+    }
+
+    virtual void send(uint8_t data, bool rsValue, bool only4bits)
+    {
+        uint8_t base = backlightBit | (rsValue ? rsMask : 0);
+
+        wire->beginTransmission(address);
+
+        // Set RS before raising E.
+        wire->write(base | (only4bits ? data << 4 : data & 0xF0));
+        if (!only4bits) { writeNibble(base, data >> 4); }
+        writeNibble(base, data & 0x0F);
+
+        wire->endTransmission();
+    }
+
+    virtual void sendBlock(const uint8_t * data, size_t length, bool rsValue)
+    {
+        // There are two I2C bytes between the pulses on E for consecutive LCD
+        // bytes in a transmission.  If the LCD needs longer than that, send
+        // each byte in its own transmission and wait after it.
+        if (getTiming().data > blockGap)
+        {
+            while (length--)
+            {
+                send(*data++, rsValue, false);
+                waitForData();
+            }
+            return;
+        }
+
+        uint8_t base = backlightBit | (rsValue ? rsMask : 0);
+
+        while (length)
+        {
+            // Each byte takes 4 bytes of the transmission, plus one at the
+            // start to set RS, and the Wire library for AVRs can only buffer
+            // 32 bytes.
+            uint8_t count = length < 7 ? length : 7;
+            length -= count;
+
+            wire->beginTransmission(address);
+            wire->write(base | (*data & 0xF0));
+            while (count--)
+            {
+                writeNibble(base, *data >> 4);
+                writeNibble(base, *data & 0x0F);
+                data++;
+            }
+            wire->endTransmission();
+        }
+    }
+
+    virtual uint16_t sendTime()
+    {
+        // 360 us at 100 kHz, which is what the PCF8574 is rated for, and
+        // 90 us at 400 kHz.
+        return busTime;
+    }
+
+private:
+
+    static const uint8_t rsMask = 1 << 0;
+    static const uint8_t eMask = 1 << 2;
+    static const uint8_t backlightMask = 1 << 3;
+
+    // Adds the bytes that raise and lower E with the given nibble on DB4
+    // through DB7.  Each byte takes at least 9 us to send even at 1 MHz, so
+    // the E pulse is plenty long.  The data does not change in the byte that lowers E, so the
+    // hold time is satisfied too.
+    void writeNibble(uint8_t base, uint8_t nibble)
+    {
+        uint8_t value = base | nibble << 4;
+        wire->write(value | eMask);
+        wire->write(value);
+    }
+
+    TwoWire * wire;
+    uint8_t address;
+    uint8_t backlightBit;
+    uint16_t busTime;
+    uint16_t blockGap;
+};
@@ -0,0 +1,224 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+#include <PololuHD44780Marquee.h>
+
+PololuHD44780Marquee::PololuHD44780Marquee(PololuHD44780Base & lcd,
+    uint8_t width)
+{
+    this->lcd = &lcd;
+    if (width < 1) { width = 1; }
+    if (width > 40) { width = 40; }
+    this->width = width;
+    shift = 0;
+    started = false;
+    release(0);
+    release(1);
+}
+
+void PololuHD44780Marquee::setText(uint8_t line, uint8_t mode,
+    const char * text, bool fromProgmem)
+{
+    if (line > 1) { return; }
+
+    uint16_t length = 0;
+    while (fromProgmem ? pgm_read_byte(text + length) : text[length])
+    {
+        length++;
+    }
+
+    Line & l = lines[line];
+    l.text = text;
+    l.length = length;
+    l.offset = 0;
+    l.mode = mode;
+    l.fromProgmem = fromProgmem;
+
+    if (started) { load(line); }
+}
+
+void PololuHD44780Marquee::release(uint8_t line)
+{
+    if (line > 1) { return; }
+    lines[line].mode = none;
+    lines[line].length = 0;
+}
+
+// Returns a character of the text for a line.  Scrolling text repeats, while
+// static text is followed by spaces.
+uint8_t PololuHD44780Marquee::charAt(uint8_t line, uint16_t index)
+{
+    const Line & l = lines[line];
+    if (l.mode == scrolling)
+    {
+        if (l.length == 0) { return ' '; }
+        index %= l.length;
+    }
+    else if (index >= l.length)
+    {
+        return ' ';
+    }
+    return l.fromProgmem ? pgm_read_byte(l.text + index) : l.text[index];
+}
+
+// Returns what a column of a static line holds when the display is scrolled
+// to the specified position.  The columns that are not shown hold spaces.
+uint8_t PololuHD44780Marquee::heldAt(uint8_t line, uint8_t column,
+    uint8_t shift)
+{
+    uint8_t x = (column + 40 - shift) % 40;
+    return x < width ? charAt(line, x) : ' ';
+}
+
+// Writes all 40 columns of a line.
+void PololuHD44780Marquee::load(uint8_t line)
+{
+    uint8_t chars[40];
+    for (uint8_t column = 0; column < 40; column++)
+    {
+        if (lines[line].mode == scrolling)
+        {
+            uint8_t x = (column + 40 - shift) % 40;
+            chars[column] = charAt(line, lines[line].offset + x);
+        }
+        else
+        {
+            chars[column] = heldAt(line, column, shift);
+        }
+    }
+    writeColumns(line, 0, chars, 40);
+}
+
+void PololuHD44780Marquee::begin()
+{
+    lcd->fastHome();
+    lcd->leftToRight();
+    lcd->noAutoscroll();
+    shift = 0;
+    started = true;
+
+    for (uint8_t line = 0; line < 2; line++)
+    {
+        if (lines[line].mode != none) { load(line); }
+    }
+}
+
+void PololuHD44780Marquee::scrollLeft()
+{
+    if (!started) { begin(); }
+
+    uint8_t oldShift = shift;
+    lcd->scrollDisplayLeft();
+    shift = (shift + 1) % 40;
+
+    for (uint8_t line = 0; line < 2; line++)
+    {
+        Line & l = lines[line];
+        if (l.mode == scrolling)
+        {
+            // The column that was at the left edge is now at the far end of
+            // the 40 columns, so it needs the character that comes 40 after
+            // the one it held.  Unless the screen is 40 columns wide, that
+            // column is not shown right now.
+            uint8_t oldChar = charAt(line, l.offset);
+            if (l.length) { l.offset = (l.offset + 1) % l.length; }
+            uint8_t newChar = charAt(line, l.offset + 39);
+            if (newChar != oldChar)
+            {
+                writeColumns(line, oldShift, &newChar, 1);
+            }
+        }
+        else if (l.mode == fixed)
+        {
+            fixStatic(line, oldShift);
+        }
+    }
+}
+
+void PololuHD44780Marquee::scrollRight()
+{
+    if (!started) { begin(); }
+
+    uint8_t oldShift = shift;
+    uint8_t newShift = (shift + 39) % 40;
+
+    // Write the column that is about to appear at the left edge before it
+    // is shown.
+    for (uint8_t line = 0; line < 2; line++)
+    {
+        Line & l = lines[line];
+        if (l.mode != scrolling) { continue; }
+        uint8_t oldChar = charAt(line, l.offset + 39);
+        if (l.length) { l.offset = (l.offset + l.length - 1) % l.length; }
+        uint8_t newChar = charAt(line, l.offset);
+        if (newChar != oldChar)
+        {
+            writeColumns(line, newShift, &newChar, 1);
+        }
+    }
+
+    lcd->scrollDisplayRight();
+    shift = newShift;
+
+    for (uint8_t line = 0; line < 2; line++)
+    {
+        if (lines[line].mode == fixed) { fixStatic(line, oldShift); }
+    }
+}
+
+// Rewrites the characters of a static line that are wrong after scrolling by
+// one column in either direction.
+void PololuHD44780Marquee::fixStatic(uint8_t line, uint8_t oldShift)
+{
+    // The columns shown before and after the scroll.
+    uint8_t start = (oldShift + 1) % 40 == shift ? oldShift : shift;
+    uint8_t count = width < 40 ? width + 1 : 40;
+
+    uint8_t run[40];
+    uint8_t runStart = 0;
+    uint8_t runLength = 0;
+    for (uint8_t i = 0; i <= count; i++)
+    {
+        uint8_t column = (start + i) % 40;
+        bool changed = false;
+        uint8_t c = 0;
+        if (i < count)
+        {
+            c = heldAt(line, column, shift);
+            changed = c != heldAt(line, column, oldShift);
+        }
+
+        if (changed)
+        {
+            if (runLength == 0) { runStart = column; }
+            run[runLength++] = c;
+        }
+        else if (runLength)
+        {
+            writeColumns(line, runStart, run, runLength);
+            runLength = 0;
+        }
+    }
+}
+
+// Writes characters to consecutive columns of a line, wrapping around from
+// column 39 to column 0.
+void PololuHD44780Marquee::writeColumns(uint8_t line, uint8_t column,
+    const uint8_t * chars, uint8_t count)
+{
+    while (count)
+    {
+        // PololuHD44780Base::write() moves on to the next row when it reaches
+        // the end of one, so do not let a run cross the end of a row.
+        uint8_t end = (column / width + 1) * width;
+        if (end > 40) { end = 40; }
+        uint8_t run = end - column;
+        if (run > count) { run = count; }
+
+        lcd->command(0x80 | (line ? 0x40 : 0) | column);
+        lcd->write(chars, run);
+
+        chars += run;
+        count -= run;
+        column = (column + run) % 40;
+    }
+}
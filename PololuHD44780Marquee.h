@@ -0,0 +1,175 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+/*! \file PololuHD44780Marquee.h
+ *
+ * This header defines the PololuHD44780Marquee class. */
+
+#pragma once
+#include <PololuHD44780.h>
+
+/*! \brief Scrolls text across the LCD using its scrolling commands.
+ *
+ * Each line of the HD44780's display RAM holds 40 characters, but only the
+ * first few are shown.  The LCD's "Cursor or display shift" command moves
+ * which 40 characters are shown by one column in about 37 microseconds,
+ * wrapping around from the end of the line to the start.  Rewriting a 16
+ * character line to scroll it by one column takes 17 transfers instead.
+ *
+ * This class uses the shift command to scroll text that is longer than the
+ * screen.  When it starts, it fills all 40 columns of a scrolling line,
+ * including the ones that are not shown, with the next part of the text.
+ * After that, each step sends one shift command and rewrites the one column
+ * that went from one end of the 40 characters to the other, which needs at
+ * most two transfers per scrolling line no matter how wide the screen is.
+ *
+ * The shift command moves both lines at once.  If one line should stay
+ * still while the other scrolls, pass its text to setStatic().  After each
+ * step, this class rewrites the characters of that line that ended up in the
+ * wrong place.  Only characters that differ from their neighbor need to be
+ * rewritten, so a line that is blank or made of a repeated character costs
+ * nothing, while a line of text costs up to one transfer per character.
+ *
+ * Example:
+ *
+ * ~~~{.cpp}
+ * PololuHD44780Marquee marquee(lcd, 16);
+ *
+ * void setup()
+ * {
+ *     marquee.setScrolling(0, "Breaking news: the LCD is scrolling.   ");
+ *     marquee.setStatic(1, "Temperature: 21C");
+ *     marquee.begin();
+ * }
+ *
+ * void loop()
+ * {
+ *     marquee.scrollLeft();
+ *     delay(300);
+ * }
+ * ~~~
+ *
+ * Text on a scrolling line repeats forever, so you should end it with a few
+ * spaces.  The text is not copied, so it must stay valid (and unchanged)
+ * while the marquee uses it.  To change it, call setScrolling() or
+ * setStatic() again.
+ *
+ * This class keeps track of how far the display is scrolled, so you should
+ * not scroll the LCD or write to it in other ways between begin() and the
+ * steps that follow, except on lines that you have not given this class any
+ * text for.  Those lines are scrolled along with the others.  Since this
+ * class writes directly to the LCD, it does not work while a framebuffer is
+ * enabled.
+ *
+ * It works best on LCDs with one or two rows.  On LCDs with four rows, the
+ * third and fourth rows are the hidden parts of the first and second lines,
+ * so they show the rest of the 40 characters.  To put the screen back the way
+ * it was, call PololuHD44780Base::fastHome(). */
+class PololuHD44780Marquee
+{
+public:
+    /*! Creates a new marquee.
+     *
+     * @param lcd The LCD to scroll.
+     * @param width The number of characters in each row of the screen, from 1
+     *   to 40.  If you have called PololuHD44780Base::setGeometry(), this
+     *   should be the same number of columns. */
+    PololuHD44780Marquee(PololuHD44780Base & lcd, uint8_t width = 16);
+
+    /*! Makes a line scroll with the specified text, starting from the
+     * beginning of the text.  If begin() has already been called, this writes
+     * the whole line right away.
+     *
+     * @param line The line (0 or 1).
+     * @param text The text, which must stay valid while it is used. */
+    void setScrolling(uint8_t line, const char * text)
+    {
+        setText(line, scrolling, text, false);
+    }
+
+    /*! Same as setScrolling(uint8_t, const char *), except the text is in
+     * program space, for example from the `F()` macro. */
+    void setScrolling(uint8_t line, const __FlashStringHelper * text)
+    {
+        setText(line, scrolling, (const char *)text, true);
+    }
+
+    /*! Makes a line stay still while the others scroll.  If the text is
+     * shorter than the width of the screen, the rest of the line is blank.
+     * If begin() has already been called, this writes the line right away.
+     *
+     * @param line The line (0 or 1).
+     * @param text The text, which must stay valid while it is used. */
+    void setStatic(uint8_t line, const char * text)
+    {
+        setText(line, fixed, text, false);
+    }
+
+    /*! Same as setStatic(uint8_t, const char *), except the text is in
+     * program space, for example from the `F()` macro. */
+    void setStatic(uint8_t line, const __FlashStringHelper * text)
+    {
+        setText(line, fixed, (const char *)text, true);
+    }
+
+    /*! Makes this class leave a line alone.  The line still moves when the
+     * display is scrolled. */
+    void release(uint8_t line);
+
+    /*! Resets the LCD's scrolling position with
+     * PololuHD44780Base::fastHome(), puts it in left-to-right mode, and
+     * writes every line that has text. */
+    void begin();
+
+    /*! Moves the text on the scrolling lines one column to the left, like a
+     * news ticker. */
+    void scrollLeft();
+
+    /*! Moves the text on the scrolling lines one column to the right. */
+    void scrollRight();
+
+    /*! Returns the column of the LCD's display RAM that is shown at the left
+     * edge of the screen, from 0 to 39. */
+    uint8_t getShift() const
+    {
+        return shift;
+    }
+
+private:
+    enum Mode
+    {
+        none,
+        scrolling,
+        fixed,
+    };
+
+    struct Line
+    {
+        const char * text;
+        uint16_t length;
+
+        /* For a scrolling line, the index of the character shown at the left
+         * edge of the screen. */
+        uint16_t offset;
+
+        uint8_t mode;
+        bool fromProgmem;
+    };
+
+    void setText(uint8_t line, uint8_t mode, const char * text,
+        bool fromProgmem);
+    uint8_t charAt(uint8_t line, uint16_t index);
+    uint8_t heldAt(uint8_t line, uint8_t column, uint8_t shift);
+    void load(uint8_t line);
+    void fixStatic(uint8_t line, uint8_t oldShift);
+    void writeColumns(uint8_t line, uint8_t column, const uint8_t * chars,
+        uint8_t count);
+
+    PololuHD44780Base * lcd;
+    uint8_t width;
+
+    /* The display RAM column shown at the left edge of the screen. */
+    uint8_t shift;
+
+    bool started;
+    Line lines[2];
+};
@@ -0,0 +1,202 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+#include <PololuHD44780Model.h>
+
+// Execution times from Table 6 of the HD44780 datasheet, in microseconds.
+static const uint16_t shortExecutionTime = 37;
+static const uint16_t longExecutionTime = 1520;
+
+PololuHD44780Model::PololuHD44780Model()
+{
+    reset();
+}
+
+void PololuHD44780Model::reset()
+{
+    // The datasheet does not specify what is in DDRAM and CGRAM at power on,
+    // so we just pick something simple.
+    memset(ddram, ' ', sizeof(ddram));
+    memset(cgram, 0, sizeof(cgram));
+    address = 0;
+    inCgram = false;
+    shift = 0;
+    entry = 0b10;
+    control = 0;
+    eightBit = true;
+    haveUpperNibble = false;
+    upperNibble = 0;
+    resetCounters();
+}
+
+void PololuHD44780Model::resetCounters()
+{
+    time = 0;
+    commands = 0;
+    dataBytes = 0;
+    cycles = 0;
+}
+
+void PololuHD44780Model::transfer(uint8_t data, bool rsValue, bool only4bits)
+{
+    if (!only4bits) { busCycle(data & 0xF0, rsValue); }
+    busCycle(data << 4, rsValue);
+}
+
+void PololuHD44780Model::busCycle(uint8_t bits, bool rsValue)
+{
+    cycles++;
+
+    if (eightBit)
+    {
+        execute(bits, rsValue);
+    }
+    else if (!haveUpperNibble)
+    {
+        upperNibble = bits & 0xF0;
+        haveUpperNibble = true;
+    }
+    else
+    {
+        haveUpperNibble = false;
+        execute(upperNibble | bits >> 4, rsValue);
+    }
+}
+
+uint8_t PololuHD44780Model::read(bool rsValue)
+{
+    if (!rsValue)
+    {
+        return address;
+    }
+
+    uint8_t data = inCgram ? cgram[address & 0x3F] : ddramByte(address);
+    moveAddress();
+    return data;
+}
+
+uint8_t PololuHD44780Model::ddramByte(uint8_t address) const
+{
+    return ddram[((address & 0x40) ? 40 : 0) + (address & 0x3F) % 40];
+}
+
+uint8_t PololuHD44780Model::characterAt(uint8_t x, uint8_t y) const
+{
+    // Lines 2 and 3 of a 4-line LCD are the right halves of lines 0 and 1.
+    uint8_t column = ((y & 2) ? 20 : 0) + x + shift;
+    return ddram[((y & 1) ? 40 : 0) + column % 40];
+}
+
+// Moves the address counter after a read or write, as specified by the I/D
+// bit of the entry mode.
+void PololuHD44780Model::moveAddress()
+{
+    if (inCgram)
+    {
+        address = (address + ((entry & 0b10) ? 1 : -1)) & 0x3F;
+    }
+    else if (entry & 0b10)
+    {
+        address++;
+        if (address == 0x28) { address = 0x40; }
+        else if (address == 0x68) { address = 0x00; }
+    }
+    else
+    {
+        if (address == 0x00) { address = 0x67; }
+        else if (address == 0x40) { address = 0x27; }
+        else { address--; }
+    }
+}
+
+void PololuHD44780Model::execute(uint8_t data, bool rsValue)
+{
+    uint16_t executionTime = shortExecutionTime;
+
+    if (rsValue)
+    {
+        dataBytes++;
+        if (inCgram)
+        {
+            cgram[address & 0x3F] = data;
+        }
+        else
+        {
+            ddram[((address & 0x40) ? 40 : 0) + (address & 0x3F) % 40] = data;
+
+            if (entry & 0b01)
+            {
+                // Auto-scrolling: shift the display in the same direction
+                // as the cursor moves so the cursor stays still.
+                shift = (shift + ((entry & 0b10) ? 1 : 39)) % 40;
+            }
+        }
+        moveAddress();
+        time += executionTime;
+        return;
+    }
+
+    commands++;
+    if (data & 0x80)
+    {
+        // Set DDRAM address
+        address = data & 0x7F;
+        inCgram = false;
+    }
+    else if (data & 0x40)
+    {
+        // Set CGRAM address
+        address = data & 0x3F;
+        inCgram = true;
+    }
+    else if (data & 0x20)
+    {
+        // Function set
+        eightBit = data & 0x10;
+    }
+    else if (data & 0x10)
+    {
+        // Cursor or display shift
+        bool right = data & 0x04;
+        if (data & 0x08)
+        {
+            shift = (shift + (right ? 39 : 1)) % 40;
+        }
+        else
+        {
+            uint8_t savedEntry = entry;
+            entry = right ? 0b10 : 0b00;
+            moveAddress();
+            entry = savedEntry;
+        }
+    }
+    else if (data & 0x08)
+    {
+        // Display on/off control
+        control = data & 0b111;
+    }
+    else if (data & 0x04)
+    {
+        // Entry mode set
+        entry = data & 0b11;
+    }
+    else if (data & 0x02)
+    {
+        // Return home
+        address = 0;
+        inCgram = false;
+        shift = 0;
+        executionTime = longExecutionTime;
+    }
+    else if (data & 0x01)
+    {
+        // Clear display
+        memset(ddram, ' ', sizeof(ddram));
+        address = 0;
+        inCgram = false;
+        shift = 0;
+        entry |= 0b10;
+        executionTime = longExecutionTime;
+    }
+
+    time += executionTime;
+}
@@ -0,0 +1,192 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+/*! \file PololuHD44780Model.h
+ *
+ * This header defines PololuHD44780Model, a software model of the HD44780
+ * controller, and PololuHD44780Emulator, which lets you use the library
+ * without any LCD hardware. */
+
+#pragma once
+#include <PololuHD44780.h>
+
+/*! \brief Software model of an HD44780 LCD controller.
+ *
+ * This class keeps track of everything an HD44780 controller would store in
+ * response to a series of bus cycles: the display data RAM (DDRAM), the
+ * character generator RAM (CGRAM), the address counter, the display shift,
+ * the entry mode, the display control bits, and the interface width set by
+ * the "Function set" command.  It also keeps a virtual clock that adds up how
+ * long the controller would be busy executing each instruction, according to
+ * Table 6 of the HD44780 datasheet, and counts the commands, data bytes, and
+ * bus cycles (E pulses) it receives.
+ *
+ * Like a real HD44780, the model starts in 8-bit interface mode and only pairs
+ * up nibbles after it receives a "Function set" command selecting the 4-bit
+ * interface, so it decodes the initialization sequence sent by
+ * PololuHD44780Base exactly the way the LCD does.
+ *
+ * This class uses about 160 bytes of RAM. */
+class PololuHD44780Model
+{
+public:
+    PololuHD44780Model();
+
+    /*! Puts the model in the same state as an HD44780 that was just powered
+     * on and resets all the counters. */
+    void reset();
+
+    /*! Processes a transfer in the same form that
+     * PololuHD44780Base::send() receives it, assuming the LCD is connected
+     * with a 4-bit interface.
+     *
+     * @param data The data or command.
+     * @param rsValue True for data, false for a command.
+     * @param only4bits If true, only the lower 4 bits of the data are sent,
+     *   as one bus cycle. */
+    void transfer(uint8_t data, bool rsValue, bool only4bits);
+
+    /*! Processes one bus cycle: a falling edge on E with R/W low.
+     *
+     * @param bits The levels of DB7 through DB0.  In 4-bit mode, only DB7
+     *   through DB4 (the upper nibble) are used.
+     * @param rsValue The level of the RS line. */
+    void busCycle(uint8_t bits, bool rsValue);
+
+    /*! Performs a read (R/W high), in the form that
+     * PololuHD44780Base::receive() returns it.
+     *
+     * @param rsValue False to read the busy flag and address counter, true to
+     *   read data from the RAM at the address counter.
+     * @return The byte read.  The busy flag is always 0 because the model
+     *   executes every instruction instantly. */
+    uint8_t read(bool rsValue);
+
+    /*! Returns the byte stored at the specified DDRAM address (0x00 to 0x27
+     *  or 0x40 to 0x67). */
+    uint8_t ddramByte(uint8_t address) const;
+
+    /*! Returns the byte stored at the specified CGRAM address (0 to 63). */
+    uint8_t cgramByte(uint8_t address) const
+    {
+        return cgram[address & 0x3F];
+    }
+
+    /*! Returns the character that would be displayed at the specified
+     * position on the screen, taking the display shift into account.
+     *
+     * @param x The physical column, with 0 being the leftmost.
+     * @param y The line, using the same 20&times;4 layout as
+     *   PololuHD44780Base::gotoXY(). */
+    uint8_t characterAt(uint8_t x, uint8_t y) const;
+
+    /*! Returns the address counter. */
+    uint8_t addressCounter() const { return address; }
+
+    /*! Returns true if the address counter points to CGRAM, or false if it
+     * points to DDRAM. */
+    bool addressInCgram() const { return inCgram; }
+
+    /*! Returns how many columns the display has been shifted to the left,
+     * from 0 to 39. */
+    uint8_t displayShift() const { return shift; }
+
+    /*! Returns the I/D and S bits of the last "Entry mode set" command. */
+    uint8_t entryMode() const { return entry; }
+
+    /*! Returns the D, C, and B bits of the last "Display on/off control"
+     * command. */
+    uint8_t displayControl() const { return control; }
+
+    /*! Returns true if the model is using the 8-bit interface. */
+    bool eightBitInterface() const { return eightBit; }
+
+    /*! Returns the total time, in microseconds, that the controller would have
+     *  spent executing the instructions received since the last reset. */
+    uint32_t busyTime() const { return time; }
+
+    /*! Returns the number of commands received since the last reset. */
+    uint16_t commandCount() const { return commands; }
+
+    /*! Returns the number of data bytes received since the last reset. */
+    uint16_t dataCount() const { return dataBytes; }
+
+    /*! Returns the number of bus cycles (E pulses) since the last reset. */
+    uint16_t busCycleCount() const { return cycles; }
+
+    /*! Resets the time and counters without changing anything else. */
+    void resetCounters();
+
+private:
+    void execute(uint8_t data, bool rsValue);
+    void moveAddress();
+
+    uint8_t ddram[80];
+    uint8_t cgram[64];
+    uint8_t address;
+    bool inCgram;
+    uint8_t shift;
+    uint8_t entry;
+    uint8_t control;
+    bool eightBit;
+
+    /* In 4-bit mode, true if the upper nibble has been received and we are
+     * waiting for the lower one. */
+    bool haveUpperNibble;
+    uint8_t upperNibble;
+
+    uint32_t time;
+    uint16_t commands, dataBytes, cycles;
+};
+
+/*! \brief Class that uses a PololuHD44780Model instead of an actual LCD.
+ *
+ * This class lets you run code that uses the LCD on a board without an LCD
+ * attached, or on a computer with a stand-in for the Arduino core, and then
+ * check what would have been displayed using the model.
+ *
+ * For example, this code prints the top line of a 16&times;2 LCD:
+ *
+ * ~~~{.cpp}
+ * PololuHD44780Emulator lcd;
+ * lcd.print("hello");
+ * for (uint8_t x = 0; x < 16; x++)
+ * {
+ *     Serial.write(lcd.model.characterAt(x, 0));
+ * }
+ * ~~~
+ */
+class PololuHD44780Emulator : public PololuHD44780Base
+{
+public:
+    /*! Creates a new instance of PololuHD44780Emulator.
+     *
+     * @param busyFlag If true, the emulated LCD supports reading, so
+     *   PololuHD44780Base polls its busy flag instead of delaying, which makes
+     *   the emulator run without any delays.  If false, PololuHD44780Base
+     *   delays after every command just like it would with a PololuHD44780. */
+    PololuHD44780Emulator(bool busyFlag = false)
+    {
+        this->busyFlag = busyFlag;
+    }
+
+    virtual void initPins()
+    {
+    }
+
+    virtual void send(uint8_t data, bool rsValue, bool only4bits)
+    {
+        model.transfer(data, rsValue, only4bits);
+    }
+
+    virtual int16_t receive(bool rsValue)
+    {
+        if (!busyFlag) { return -1; }
+        return model.read(rsValue);
+    }
+
+    /*! The model of the emulated LCD's controller. */
+    PololuHD44780Model model;
+
+private:
+    bool busyFlag;
+};
@@ -0,0 +1,90 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+#include <PololuHD44780Regions.h>
+
+void PololuHD44780Region::submit(const char * text)
+{
+    sequence++;
+    barrier();
+
+    uint8_t i = 0;
+    while (i < size && text[i])
+    {
+        pending[i] = text[i];
+        i++;
+    }
+    length = i;
+
+    barrier();
+    sequence++;
+    dirty = true;
+}
+
+void PololuHD44780Regions::add(PololuHD44780Region & region)
+{
+    remove(region);
+    region.next = first;
+    first = &region;
+    region.dirty = true;
+    lcd->addField(*region.field);
+}
+
+void PololuHD44780Regions::remove(PololuHD44780Region & region)
+{
+    PololuHD44780Region ** p = &first;
+    while (*p)
+    {
+        if (*p == &region)
+        {
+            *p = region.next;
+            region.next = NULL;
+            break;
+        }
+        p = &(*p)->next;
+    }
+    lcd->removeField(*region.field);
+}
+
+bool PololuHD44780Regions::update()
+{
+    bool done = true;
+    for (PololuHD44780Region * r = first; r; r = r->next)
+    {
+        if (!r->dirty) { continue; }
+
+        PololuHD44780Region::Sequence sequence = r->sequence;
+        if (sequence & 1)
+        {
+            // The text is being changed right now.
+            done = false;
+            continue;
+        }
+
+        // Clear the flag before copying, so a change that happens while we
+        // copy sets it again.
+        r->dirty = false;
+        PololuHD44780Region::barrier();
+
+        char text[PololuHD44780Field::maxWidth + 1];
+        uint8_t length = r->length;
+        if (length > r->size) { length = r->size; }
+        for (uint8_t i = 0; i < length; i++)
+        {
+            text[i] = r->pending[i];
+        }
+        text[length] = 0;
+
+        PololuHD44780Region::barrier();
+        if (r->sequence != sequence)
+        {
+            // The text changed while we were copying it, so the copy might
+            // be a mix of the old and new text.
+            r->dirty = true;
+            done = false;
+            continue;
+        }
+
+        lcd->printField(*r->field, text);
+    }
+    return done;
+}
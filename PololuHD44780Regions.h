@@ -0,0 +1,182 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+/*! \file PololuHD44780Regions.h
+ *
+ * This header defines classes that let several tasks or interrupts update
+ * different parts of the screen without waiting for each other or for the
+ * LCD. */
+
+#pragma once
+#include <PololuHD44780.h>
+
+/*! \brief A part of the screen whose text can be changed from any task or
+ * interrupt.
+ *
+ * Calling submit() only copies the text into this object, so it never waits
+ * for the LCD or for another task, and it does not touch the LCD object at
+ * all.  The task that owns the LCD calls PololuHD44780Regions::update() to
+ * send the latest text of each region to the LCD, using
+ * PololuHD44780Base::printField() so that only the characters that changed
+ * are sent.  If a region's text is submitted several times before the owner
+ * gets to it, only the last text is sent.
+ *
+ * Each region must only have one writer: submit() is not safe to call for
+ * the same region from two tasks, or from a task and an interrupt, that can
+ * run at the same time, and doing so can leave a mix of both texts on the
+ * screen.  Give each writer its own region instead.  Different regions can be
+ * written by different tasks at the same time.
+ *
+ * To create a region, use PololuHD44780RegionBuffer. */
+class PololuHD44780Region
+{
+public:
+    /*! Sets the text that the region should show.  If the text is longer than
+     * the region, the extra characters are ignored.  This function can be
+     * called from any task or interrupt, as long as it is the only one that
+     * writes to this region. */
+    void submit(const char * text);
+
+    /*! Returns the field that shows the region on the LCD. */
+    PololuHD44780Field & getField()
+    {
+        return *field;
+    }
+
+protected:
+
+    PololuHD44780Region(PololuHD44780Field * field, char * pending,
+        uint8_t size)
+    {
+        this->field = field;
+        this->pending = pending;
+        if (size > PololuHD44780Field::maxWidth)
+        {
+            size = PololuHD44780Field::maxWidth;
+        }
+        this->size = size;
+        length = 0;
+        sequence = 0;
+        dirty = false;
+        next = NULL;
+    }
+
+private:
+    friend class PololuHD44780Regions;
+
+    // Keeps the compiler (and the CPU, on processors that reorder memory
+    // accesses) from moving reads and writes of the text across the changes
+    // to sequence and dirty.
+    static void barrier()
+    {
+#ifdef __AVR__
+        asm volatile("" ::: "memory");
+#else
+        __sync_synchronize();
+#endif
+    }
+
+    PololuHD44780Field * field;
+
+    /* The latest text submitted. */
+    char * pending;
+    uint8_t size;
+    volatile uint8_t length;
+
+    /* Incremented before and after the text is changed, so it is odd while
+     * the text is being changed.  On AVRs it has to be one byte so that it
+     * is read atomically.  Elsewhere it is wider, so a writer on another core
+     * cannot submit so many times during one copy that it wraps around to
+     * the same value. */
+#ifdef __AVR__
+    typedef uint8_t Sequence;
+#else
+    typedef uint32_t Sequence;
+#endif
+    volatile Sequence sequence;
+
+    /* True if the text has changed since the owner last read it. */
+    volatile bool dirty;
+
+    PololuHD44780Region * next;
+};
+
+/*! \brief A PololuHD44780Region with storage for a fixed number of
+ * characters.
+ *
+ * Each region takes about 20 bytes of RAM plus two bytes per character.
+ *
+ * @tparam regionSize The number of characters in the region, from 1 to 40. */
+template <uint8_t regionSize> class PololuHD44780RegionBuffer :
+    public PololuHD44780Region
+{
+public:
+    /*! Creates a new region.  The parameters are the same as for
+     * PololuHD44780FieldBuffer::PololuHD44780FieldBuffer(). */
+    PololuHD44780RegionBuffer(uint8_t x, uint8_t y,
+        uint8_t alignment = PololuHD44780Field::alignLeft)
+        : PololuHD44780Region(&field, pending, regionSize),
+          field(x, y, alignment)
+    {
+    }
+
+private:
+    PololuHD44780FieldBuffer<regionSize> field;
+    char pending[regionSize];
+};
+
+/*! \brief Sends the text of several PololuHD44780Region objects to an LCD.
+ *
+ * This lets one task own the LCD while other tasks and interrupts change
+ * what it shows, without a mutex around the LCD.  The other tasks never
+ * wait: they call PololuHD44780Region::submit(), which returns right away,
+ * and the owner calls update() whenever it is ready to talk to the LCD.
+ *
+ * Example:
+ *
+ * ~~~{.cpp}
+ * PololuHD44780RegionBuffer<8> status(0, 0);
+ * PololuHD44780RegionBuffer<6> speed(10, 1, PololuHD44780Field::alignRight);
+ * PololuHD44780Regions regions(lcd);
+ *
+ * // In setup, before the other tasks start:
+ * regions.add(status);
+ * regions.add(speed);
+ *
+ * // In any task or interrupt:
+ * speed.submit("12.3");
+ *
+ * // In the task that owns the LCD:
+ * regions.update();
+ * ~~~
+ *
+ * Only the owner should call functions of this class or of the LCD object.
+ * The regions should be added before the other tasks start using them. */
+class PololuHD44780Regions
+{
+public:
+    /*! Creates a new object that will send regions to the specified LCD. */
+    PololuHD44780Regions(PololuHD44780Base & lcd)
+    {
+        this->lcd = &lcd;
+        first = NULL;
+    }
+
+    /*! Adds a region, and adds its field to the LCD with
+     * PololuHD44780Base::addField(). */
+    void add(PololuHD44780Region & region);
+
+    /*! Removes a region, and removes its field from the LCD. */
+    void remove(PololuHD44780Region & region);
+
+    /*! Sends the latest text of each region that has changed to the LCD.
+     *
+     * If a region's text was being changed while this function was reading
+     * it, that region is left for the next call.
+     *
+     * @return True if every region has been sent. */
+    bool update();
+
+private:
+    PololuHD44780Base * lcd;
+    PololuHD44780Region * first;
+};
@@ -0,0 +1,135 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+/*! \file PololuHD44780SPI.h
+ *
+ * This header defines the PololuHD44780SPI class, for LCDs connected through
+ * a 74HC595 shift register on the SPI bus. */
+
+#pragma once
+#include <PololuHD44780.h>
+#include <SPI.h>
+
+/*! \brief Class for interfacing with HD44780 LCDs through a 74HC595 shift
+ * register.
+ *
+ * This class assumes that the shift register's serial input (SER) and clock
+ * (SRCLK) are connected to the microcontroller's hardware SPI MOSI and SCK
+ * pins, its latch clock (RCLK) is connected to a separate pin, and its outputs
+ * drive the LCD's RS, E, and DB4 through DB7 pins.  The R/W pin of the LCD must
+ * be tied low.
+ *
+ * Each byte sent to the LCD is turned into a series of register images that
+ * set up RS and the data, raise E, and lower E again for each nibble.  The
+ * images for a byte are computed before the bus is claimed and then shifted
+ * out in a single SPI transaction, with a pulse on the latch pin after each
+ * one.  When writing strings, the transaction ends after each byte, so other
+ * devices can use the SPI bus while the LCD processes it.
+ *
+ * You must call `SPI.begin()` before using the LCD. */
+class PololuHD44780SPI : public PololuHD44780Base
+{
+public:
+    /*! Creates a new instance of PololuHD44780SPI.
+     *
+     * @param latch The pin number for the microcontroller pin that is
+     *   connected to RCLK of the shift register.
+     * @param rsBit The shift register output (0 for QA through 7 for QH)
+     *   connected to the RS pin of the LCD.
+     * @param eBit The shift register output connected to the E pin of the LCD.
+     * @param db4Bit The shift register output connected to DB4 of the LCD.
+     *   DB5, DB6, and DB7 must be connected to the next three outputs.
+     * @param clockSpeed The SPI clock speed, in Hz.  The 74HC595 can handle at
+     *   least 4 MHz at 2 V, and much more at 5 V. */
+    PololuHD44780SPI(uint8_t latch, uint8_t rsBit = 1, uint8_t eBit = 2,
+        uint8_t db4Bit = 4, uint32_t clockSpeed = 4000000)
+        : settings(clockSpeed, MSBFIRST, SPI_MODE0)
+    {
+        this->latch = latch;
+        rsMask = 1 << rsBit;
+        eMask = 1 << eBit;
+        this->db4Bit = db4Bit;
+    }
+
+    virtual void initPins()
+    {
+        digitalWrite(latch, LOW);
+        pinMode(latch, OUTPUT);
+
+        // Drive E low.
+        const uint8_t image = 0;
+        writeImages(&image, 1);
+    }
+
+    virtual void send(uint8_t data, bool rsValue, bool only4bits)
+    {
+        uint8_t images[maxImages];
+        uint8_t count = 0;
+        uint8_t base = rsValue ? rsMask : 0;
+
+        // Set RS before raising E.
+        images[count++] = base;
+        if (!only4bits) { count = addNibble(images, count, base, data >> 4); }
+        count = addNibble(images, count, base, data & 0x0F);
+
+        writeImages(images, count);
+    }
+
+    virtual void sendBlock(const uint8_t * data, size_t length, bool rsValue)
+    {
+        uint8_t images[maxImages];
+        uint8_t base = rsValue ? rsMask : 0;
+        bool first = true;
+
+        while (length--)
+        {
+            // RS only needs to be set up before the first byte, since the
+            // last image for each byte leaves it in place.
+            uint8_t count = 0;
+            if (first) { images[count++] = base; }
+            first = false;
+            count = addNibble(images, count, base, *data >> 4);
+            count = addNibble(images, count, base, *data & 0x0F);
+            data++;
+
+            writeImages(images, count);
+            waitForData();
+        }
+    }
+
+private:
+
+    // The images for one byte: one to set up RS, and two for each nibble.
+    static const uint8_t maxImages = 5;
+
+    // Adds the images that raise and lower E with the given nibble on DB4
+    // through DB7, and returns the new number of images.
+    uint8_t addNibble(uint8_t * images, uint8_t count, uint8_t base,
+        uint8_t nibble)
+    {
+        uint8_t image = base | nibble << db4Bit;
+        images[count++] = image | eMask;
+        images[count++] = image;
+        return count;
+    }
+
+    // Shifts out each register image and latches it onto the outputs, all in
+    // one SPI transaction.  The time it takes to do that is enough to satisfy
+    // all of the LCD's setup, hold, and pulse width requirements.
+    void writeImages(const uint8_t * images, uint8_t count)
+    {
+        SPI.beginTransaction(settings);
+        for (uint8_t i = 0; i < count; i++)
+        {
+            SPI.transfer(images[i]);
+            digitalWrite(latch, HIGH);
+            digitalWrite(latch, LOW);
+        }
+        SPI.endTransaction();
+    }
+
+    SPISettings settings;
+    uint8_t latch;
+    uint8_t rsMask;
+    uint8_t eMask;
+    uint8_t db4Bit;
+};
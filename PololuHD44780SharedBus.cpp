@@ -0,0 +1,167 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+#include <PololuHD44780SharedBus.h>
+
+PololuHD44780MultiScreen::PololuHD44780MultiScreen(
+    PololuHD44780Base * const * controllers, uint8_t count, uint8_t columns,
+    uint8_t rowsPerController)
+{
+    this->controllers = controllers;
+    this->count = count;
+    this->columns = columns;
+    this->rowsPerController = rowsPerController;
+    x = y = 0;
+    active = 0;
+    cursorMode = 0;
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        controllers[i]->setGeometry(
+            PololuHD44780Geometry(columns, rowsPerController));
+    }
+}
+
+void PololuHD44780MultiScreen::clear()
+{
+    // Each clear command only makes the controller that received it busy, so
+    // they can all run at the same time.
+    for (uint8_t i = 0; i < count; i++)
+    {
+        controllers[i]->clear();
+    }
+    x = y = 0;
+    selectController(0);
+}
+
+void PololuHD44780MultiScreen::gotoXY(uint8_t x, uint8_t y)
+{
+    if (y >= count * rowsPerController) { y = count * rowsPerController - 1; }
+    this->x = x;
+    this->y = y;
+    selectController(y / rowsPerController);
+    controllers[active]->gotoXY(x, y % rowsPerController);
+}
+
+size_t PololuHD44780MultiScreen::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+size_t PololuHD44780MultiScreen::write(const uint8_t * buffer, size_t size)
+{
+    size_t n = size;
+    while (n)
+    {
+        // When the previous row filled up, the controller moves its own
+        // cursor to its next row, but we need to move to the next
+        // controller after its last row.
+        if (x >= columns)
+        {
+            x = 0;
+            y++;
+            if (y >= count * rowsPerController) { y = 0; }
+            if (y % rowsPerController == 0) { gotoXY(0, y); }
+        }
+
+        size_t run = columns - x;
+        if (run > n) { run = n; }
+        controllers[active]->write(buffer, run);
+        buffer += run;
+        n -= run;
+        x += run;
+    }
+    return size;
+}
+
+void PololuHD44780MultiScreen::loadCustomCharacter(const uint8_t * picture,
+    uint8_t number)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        controllers[i]->loadCustomCharacter(picture, number);
+    }
+}
+
+void PololuHD44780MultiScreen::loadCustomCharacterFromRam(
+    const uint8_t * picture, uint8_t number)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        controllers[i]->loadCustomCharacterFromRam(picture, number);
+    }
+}
+
+void PololuHD44780MultiScreen::noDisplay()
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        controllers[i]->noDisplay();
+    }
+}
+
+void PololuHD44780MultiScreen::display()
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        controllers[i]->display();
+    }
+}
+
+void PololuHD44780MultiScreen::cursorSolid()
+{
+    showCursor(1);
+}
+
+void PololuHD44780MultiScreen::cursorBlinking()
+{
+    showCursor(2);
+}
+
+void PololuHD44780MultiScreen::hideCursor()
+{
+    showCursor(0);
+}
+
+void PololuHD44780MultiScreen::scrollDisplayLeft()
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        controllers[i]->scrollDisplayLeft();
+    }
+}
+
+void PololuHD44780MultiScreen::scrollDisplayRight()
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        controllers[i]->scrollDisplayRight();
+    }
+}
+
+bool PololuHD44780MultiScreen::poll()
+{
+    bool empty = true;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (!controllers[i]->poll()) { empty = false; }
+    }
+    return empty;
+}
+
+// Makes the specified controller the active one, moving the cursor to it.
+void PololuHD44780MultiScreen::selectController(uint8_t index)
+{
+    if (index == active) { return; }
+    if (cursorMode) { controllers[active]->hideCursor(); }
+    active = index;
+    showCursor(cursorMode);
+}
+
+void PololuHD44780MultiScreen::showCursor(uint8_t cursorMode)
+{
+    this->cursorMode = cursorMode;
+    PololuHD44780Base * lcd = controllers[active];
+    if (cursorMode == 1) { lcd->cursorSolid(); }
+    else if (cursorMode == 2) { lcd->cursorBlinking(); }
+    else { lcd->hideCursor(); }
+}
@@ -0,0 +1,278 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+/*! \file PololuHD44780SharedBus.h
+ *
+ * This header defines classes for controlling several HD44780 controllers
+ * that share the same RS and data lines, such as the two controllers of a
+ * 40&times;4 LCD or several LCDs wired to the same pins. */
+
+#pragma once
+#include <PololuHD44780.h>
+
+/*! \brief The RS and DB4 through DB7 lines shared by several HD44780
+ * controllers.
+ *
+ * Each controller on the bus has its own E line, so only the controller
+ * whose E line is pulsed receives a transfer.  This class does not do
+ * anything by itself; create one PololuHD44780SharedBusLcd for each
+ * controller. */
+class PololuHD44780SharedBus
+{
+public:
+    /*! Creates a new instance of PololuHD44780SharedBus.  The parameters are
+     * the pin numbers for the microcontroller pins connected to the RS and
+     * DB4 through DB7 pins of every LCD controller on the bus. */
+    PololuHD44780SharedBus(uint8_t rs, uint8_t db4, uint8_t db5, uint8_t db6,
+        uint8_t db7)
+    {
+        this->rs = rs;
+        this->db4 = db4;
+        this->db5 = db5;
+        this->db6 = db6;
+        this->db7 = db7;
+    }
+
+    /*! Sends data or a command to the controller whose E line is connected
+     * to the specified pin.  The parameters are otherwise the same as
+     * PololuHD44780Base::send(). */
+    void send(uint8_t e, uint8_t data, bool rsValue, bool only4bits)
+    {
+        digitalWrite(rs, rsValue);
+
+        pinMode(rs, OUTPUT);
+        pinMode(db4, OUTPUT);
+        pinMode(db5, OUTPUT);
+        pinMode(db6, OUTPUT);
+        pinMode(db7, OUTPUT);
+
+        if (!only4bits) { sendNibble(e, data >> 4); }
+        sendNibble(e, data & 0x0F);
+    }
+
+private:
+
+    void sendNibble(uint8_t e, uint8_t data)
+    {
+        digitalWrite(db4, data >> 0 & 1);
+        digitalWrite(db5, data >> 1 & 1);
+        digitalWrite(db6, data >> 2 & 1);
+        digitalWrite(db7, data >> 3 & 1);
+
+        digitalWrite(e, HIGH);
+        _delay_us(1);  // Must be at least 450 ns.
+        digitalWrite(e, LOW);
+        _delay_us(1);  // Must be at least 550 ns.
+    }
+
+    uint8_t rs, db4, db5, db6, db7;
+};
+
+/*! \brief Class for one HD44780 controller on a PololuHD44780SharedBus.
+ *
+ * This class works like PololuHD44780, except that it sends everything
+ * through a PololuHD44780SharedBus, so several of them can use the same RS and
+ * data pins as long as each one has its own E pin.
+ *
+ * Instead of delaying after each transfer, this class remembers when the
+ * controller will be done executing it and reports that to
+ * PololuHD44780Base as if it were the LCD's busy flag.  That way, the delay
+ * only happens if the next transfer is for the same controller, and the
+ * program is free to send transfers to the other controllers on the bus in
+ * the meantime.  For example, clearing two controllers one after the other
+ * takes about as long as clearing one.  PololuHD44780MultiScreen takes
+ * advantage of this to treat several controllers as one screen. */
+class PololuHD44780SharedBusLcd : public PololuHD44780Base
+{
+public:
+    /*! Creates a new instance of PololuHD44780SharedBusLcd.
+     *
+     * @param bus The bus that the controller is connected to.
+     * @param e The pin number for the microcontroller pin that is connected
+     *   to the E pin of this controller. */
+    PololuHD44780SharedBusLcd(PololuHD44780SharedBus & bus, uint8_t e)
+    {
+        this->bus = &bus;
+        this->e = e;
+        lastTime = 0;
+        lastDelay = 0;
+    }
+
+    virtual void initPins()
+    {
+        digitalWrite(e, LOW);
+        pinMode(e, OUTPUT);
+    }
+
+    virtual void send(uint8_t data, bool rsValue, bool only4bits)
+    {
+        bus->send(e, data, rsValue, only4bits);
+
+        // Use the same execution times that PololuHD44780Base would delay
+        // for.
+        const PololuHD44780Timing & timing = getTiming();
+        lastTime = micros();
+        if (rsValue) { lastDelay = timing.data; }
+        else if (only4bits) { lastDelay = timing.command; }
+        else if (data == 0x01) { lastDelay = timing.clear; }
+        else if ((data & 0xFE) == 0x02) { lastDelay = timing.home; }
+        else { lastDelay = timing.command; }
+    }
+
+    /*! Does nothing and returns false.  The busy flag reported by receive()
+     * is computed from the current timing, so there is nothing to measure.
+     * To calibrate an LCD of the same type, connect it with its R/W line
+     * and use PololuHD44780Base::calibrateTiming() instead. */
+    virtual bool calibrateTiming()
+    {
+        return false;
+    }
+
+protected:
+
+    /*! Returns a busy flag based on how much time has passed since the last
+     * transfer to this controller.  Reading data is not supported. */
+    virtual int16_t receive(bool rsValue)
+    {
+        if (rsValue) { return -1; }
+        return (uint16_t)((uint16_t)micros() - lastTime) < lastDelay ? 0x80 : 0;
+    }
+
+private:
+    PololuHD44780SharedBus * bus;
+    uint8_t e;
+
+    /* The value of micros() after the last transfer, and how long that
+     * transfer takes to execute. */
+    uint16_t lastTime;
+    uint16_t lastDelay;
+};
+
+/*! \brief Class that treats several HD44780 controllers as one screen.
+ *
+ * Large LCDs such as 40&times;4 modules have two HD44780 controllers, each
+ * driving half of the rows and each with its own E line.  This class stacks
+ * the rows of several controllers on top of each other, so the rest of your
+ * program can use gotoXY() and print() as if there were only one.  The
+ * controllers can be any subclass of PololuHD44780Base, but they only work
+ * at the same time if they are PololuHD44780SharedBusLcd objects (or other
+ * classes that read a busy flag instead of delaying).
+ *
+ * For example, this code sets up a 40&times;4 LCD:
+ *
+ * ~~~{.cpp}
+ * PololuHD44780SharedBus bus(7, 5, 4, 3, 2);
+ * PololuHD44780SharedBusLcd top(bus, 6);
+ * PololuHD44780SharedBusLcd bottom(bus, 8);
+ * PololuHD44780Base * const controllers[] = { &top, &bottom };
+ * PololuHD44780MultiScreen lcd(controllers, 2, 40);
+ * ~~~
+ *
+ * Text written with this class continues on the next row (and on the next
+ * controller) when it reaches the end of a row, so this class sets the
+ * geometry of each controller.  Only left-to-right writing is supported.
+ *
+ * Each controller has its own custom characters, so loadCustomCharacter()
+ * loads the character into all of them.  The cursor is only shown by the
+ * controller that the next character will go to.
+ *
+ * You can still use each controller by itself, and you can call
+ * PololuHD44780Base::enableAsync() on each one to make them all
+ * asynchronous.  In that case, poll() sends the next ready transfer for each
+ * controller in turn, so transfers for one controller are sent while the
+ * others are busy. */
+class PololuHD44780MultiScreen : public Print
+{
+public:
+    /*! Creates a new instance of PololuHD44780MultiScreen.
+     *
+     * @param controllers An array of pointers to the controllers, from top to
+     *   bottom, which must remain valid while this object is used.
+     * @param count The number of controllers.
+     * @param columns The number of characters in each row.
+     * @param rowsPerController The number of rows each controller drives. */
+    PololuHD44780MultiScreen(PololuHD44780Base * const * controllers,
+        uint8_t count, uint8_t columns, uint8_t rowsPerController = 2);
+
+    /*! Returns the controller with the specified index. */
+    PololuHD44780Base & controller(uint8_t index)
+    {
+        return *controllers[index];
+    }
+
+    /*! Clears all the controllers and moves the cursor to the upper left
+     * corner of the screen.  The controllers execute their clear commands at
+     * the same time if they can. */
+    void clear();
+
+    /*! Moves the cursor to the specified column and row, with row 0 being the
+     * top row of the first controller. */
+    void gotoXY(uint8_t x, uint8_t y);
+
+    /*! Changes the location of the cursor.  This is just a wrapper around
+     * gotoXY provided for compaitibility with the LiquidCrystal library. */
+    void setCursor(uint8_t col, uint8_t row)
+    {
+        gotoXY(col, row);
+    }
+
+    /*! Writes a single character. */
+    virtual size_t write(uint8_t c);
+
+    /*! Writes multiple characters, moving on to the next row whenever one is
+     * filled. */
+    virtual size_t write(const uint8_t * buffer, size_t size);
+
+    using Print::write;
+
+    /*! Loads a custom character from program space into every controller.
+     * See PololuHD44780Base::loadCustomCharacter(). */
+    void loadCustomCharacter(const uint8_t * picture, uint8_t number);
+
+    /*! Loads a custom character from RAM into every controller.
+     * See PololuHD44780Base::loadCustomCharacterFromRam(). */
+    void loadCustomCharacterFromRam(const uint8_t * picture, uint8_t number);
+
+    /*! Turns off every controller's display. */
+    void noDisplay();
+
+    /*! Turns on every controller's display. */
+    void display();
+
+    /*! Shows a solid cursor.  See PololuHD44780Base::cursorSolid(). */
+    void cursorSolid();
+
+    /*! Shows a blinking cursor.  See PololuHD44780Base::cursorBlinking(). */
+    void cursorBlinking();
+
+    /*! Hides the cursor. */
+    void hideCursor();
+
+    /*! Scrolls every controller one position to the left. */
+    void scrollDisplayLeft();
+
+    /*! Scrolls every controller one position to the right. */
+    void scrollDisplayRight();
+
+    /*! Calls PololuHD44780Base::poll() for each controller.
+     *
+     * @return True if all of the queues are empty. */
+    bool poll();
+
+private:
+    void selectController(uint8_t index);
+    void showCursor(uint8_t cursorMode);
+
+    PololuHD44780Base * const * controllers;
+    uint8_t count;
+    uint8_t columns;
+    uint8_t rowsPerController;
+
+    /* The position where the next character will go. */
+    uint8_t x, y;
+
+    /* The controller that the cursor is on. */
+    uint8_t active;
+
+    /* 0 if the cursor is hidden, 1 if it is solid, 2 if it is blinking. */
+    uint8_t cursorMode;
+};
@@ -0,0 +1,266 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+#include <PololuHD44780Trace.h>
+
+void PololuHD44780TraceRing::record(uint8_t data, bool rsValue,
+    bool only4bits, uint16_t delayTime)
+{
+    if (maxLength == 0) { return; }
+
+    uint16_t index;
+    if (count < maxLength)
+    {
+        index = (start + count) % maxLength;
+        count++;
+    }
+    else
+    {
+        // Replace the oldest entry.
+        index = start;
+        start = (start + 1) % maxLength;
+        droppedCount++;
+    }
+
+    if (delayTime > maxDelay) { delayTime = maxDelay; }
+    uint16_t word = delayTime;
+    if (rsValue) { word |= rsBit; }
+    if (only4bits) { word |= only4bitBit; }
+
+    uint8_t * p = storage + index * entrySize;
+    p[0] = data;
+    p[1] = word & 0xFF;
+    p[2] = word >> 8;
+}
+
+PololuHD44780TraceRing::Entry PololuHD44780TraceRing::get(
+    uint16_t index) const
+{
+    const uint8_t * p = storage + (start + index) % maxLength * entrySize;
+    uint16_t word = p[1] | (uint16_t)p[2] << 8;
+
+    Entry entry;
+    entry.data = p[0];
+    entry.rsValue = word & rsBit;
+    entry.only4bits = word & only4bitBit;
+    entry.delayTime = word & maxDelay;
+    return entry;
+}
+
+void PololuHD44780TraceRing::replay(PololuHD44780TraceSink & sink) const
+{
+    for (uint16_t i = 0; i < count; i++)
+    {
+        Entry entry = get(i);
+        sink.record(entry.data, entry.rsValue, entry.only4bits,
+            entry.delayTime);
+    }
+}
+
+void PololuHD44780TraceAnalyzer::reset()
+{
+    model.reset();
+
+    // Most LCDs use a 4-bit interface, so if the trace does not start with
+    // the initialization sequence, it probably needs to be decoded that way.
+    // The initialization sequence works either way.
+    model.busCycle(0x20, false);
+    model.resetCounters();
+    eightBitBus = false;
+    addressKnown = false;
+    ddramKnown = false;
+    displayControlKnown = false;
+    entryModeKnown = false;
+    transfers = 0;
+    totalTime = 0;
+    memset(waste, 0, sizeof(waste));
+}
+
+void PololuHD44780TraceAnalyzer::record(uint8_t data, bool rsValue,
+    bool only4bits, uint16_t delayTime)
+{
+    transfers++;
+    totalTime += delayTime;
+
+    if (only4bits)
+    {
+        // Only sent while initializing an LCD with a 4-bit interface.
+        eightBitBus = false;
+    }
+    else if (rsValue)
+    {
+        analyzeData(data, delayTime);
+    }
+    else
+    {
+        // A function set command with DL set can only be sent as a whole byte
+        // on an 8-bit interface.
+        if ((data & 0xF0) == 0x30) { eightBitBus = true; }
+        analyzeCommand(data, delayTime);
+    }
+
+    // Update the model after checking the transfer against its old state.
+    if (eightBitBus)
+    {
+        model.busCycle(data, rsValue);
+    }
+    else
+    {
+        model.transfer(data, rsValue, only4bits);
+    }
+}
+
+void PololuHD44780TraceAnalyzer::analyzeCommand(uint8_t cmd,
+    uint16_t delayTime)
+{
+    if (cmd & 0x80)
+    {
+        // Set DDRAM address
+        if (addressKnown && !model.addressInCgram() &&
+            model.addressCounter() == (cmd & 0x7F))
+        {
+            addWaste(redundantAddress, delayTime);
+        }
+        addressKnown = true;
+    }
+    else if (cmd & 0x40)
+    {
+        // Set CGRAM address
+        if (addressKnown && model.addressInCgram() &&
+            model.addressCounter() == (cmd & 0x3F))
+        {
+            addWaste(redundantAddress, delayTime);
+        }
+        addressKnown = true;
+    }
+    else if (cmd & 0x20)
+    {
+        // Function set
+    }
+    else if (cmd & 0x10)
+    {
+        // Cursor or display shift; the model keeps track of the changes.
+    }
+    else if (cmd & 0x08)
+    {
+        if (displayControlKnown && model.displayControl() == (cmd & 0b111))
+        {
+            addWaste(unchangedDisplayControl, delayTime);
+        }
+        displayControlKnown = true;
+    }
+    else if (cmd & 0x04)
+    {
+        if (entryModeKnown && model.entryMode() == (cmd & 0b11))
+        {
+            addWaste(unchangedEntryMode, delayTime);
+        }
+        entryModeKnown = true;
+    }
+    else if (cmd & 0x02)
+    {
+        // Return home
+        addressKnown = true;
+    }
+    else if (cmd & 0x01)
+    {
+        // Clear display
+        if (ddramKnown)
+        {
+            uint16_t alternative = overwriteTime();
+            if (alternative < delayTime)
+            {
+                addWaste(avoidableClear, delayTime - alternative);
+            }
+        }
+        ddramKnown = true;
+        addressKnown = true;
+    }
+}
+
+void PololuHD44780TraceAnalyzer::analyzeData(uint8_t data,
+    uint16_t delayTime)
+{
+    if (!addressKnown)
+    {
+        // We do not know where the data went.
+        ddramKnown = false;
+        return;
+    }
+
+    // Writing to CGRAM or auto-scrolling changes the display even if the
+    // character is the same.
+    if (model.addressInCgram() || (model.entryMode() & 0b01)) { return; }
+
+    if (ddramKnown && model.ddramByte(model.addressCounter()) == data)
+    {
+        addWaste(identicalData, delayTime);
+    }
+}
+
+// Estimates how long it would take to overwrite every non-space character in
+// DDRAM with spaces, reset the display shift and entry mode, and move the
+// address counter to 0.
+uint16_t PololuHD44780TraceAnalyzer::overwriteTime() const
+{
+    uint8_t commands = 1;
+    uint8_t characters = 0;
+    for (uint8_t line = 0; line < 2; line++)
+    {
+        int8_t first = -1, last = -1;
+        for (uint8_t i = 0; i < 40; i++)
+        {
+            if (model.ddramByte(line * 0x40 + i) != ' ')
+            {
+                if (first < 0) { first = i; }
+                last = i;
+            }
+        }
+        if (first >= 0)
+        {
+            commands++;
+            characters += last - first + 1;
+        }
+    }
+
+    uint8_t shift = model.displayShift();
+    commands += shift < 20 ? shift : 40 - shift;
+    if (model.entryMode() != 0b10) { commands++; }
+
+    return commands * timing.command + characters * timing.data;
+}
+
+void PololuHD44780TraceAnalyzer::addWaste(uint8_t kind, uint16_t time)
+{
+    waste[kind].count++;
+    waste[kind].time += time;
+}
+
+const __FlashStringHelper * PololuHD44780TraceAnalyzer::kindName(uint8_t kind)
+{
+    switch (kind)
+    {
+    case redundantAddress: return F("redundant_address");
+    case identicalData: return F("identical_data");
+    case unchangedDisplayControl: return F("unchanged_display_control");
+    case unchangedEntryMode: return F("unchanged_entry_mode");
+    case avoidableClear: return F("avoidable_clear");
+    default: return F("unknown");
+    }
+}
+
+void PololuHD44780TraceAnalyzer::printReport(Print & out) const
+{
+    out.print(F("transfers="));
+    out.print(transfers);
+    out.print(F(" time="));
+    out.println(totalTime);
+
+    for (uint8_t kind = 0; kind < kindCount; kind++)
+    {
+        out.print(kindName(kind));
+        out.print(F(": count="));
+        out.print(waste[kind].count);
+        out.print(F(" time="));
+        out.println(waste[kind].time);
+    }
+}
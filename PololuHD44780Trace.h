@@ -0,0 +1,217 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+/*! \file PololuHD44780Trace.h
+ *
+ * This header defines classes for recording the transfers sent to an LCD and
+ * finding the ones that were not needed. */
+
+#pragma once
+#include <PololuHD44780.h>
+#include <PololuHD44780Model.h>
+
+/*! \brief Ring buffer that records the transfers sent to an LCD.
+ *
+ * Each transfer takes 3 bytes: the data and a 16-bit word holding the RS
+ * value, the 4-bit flag, and the delay time (limited to 16383 us).  When the
+ * buffer is full, each new transfer replaces the oldest one.
+ *
+ * You cannot create an object of this class directly.  Instead, create a
+ * PololuHD44780TraceBuffer and pass it to
+ * PololuHD44780Base::enableTrace(). */
+class PololuHD44780TraceRing : public PololuHD44780TraceSink
+{
+public:
+    /*! One recorded transfer. */
+    struct Entry
+    {
+        uint8_t data;        //!< The byte sent.
+        bool rsValue;        //!< True for data, false for a command.
+        bool only4bits;      //!< True if only the lower 4 bits were sent.
+        uint16_t delayTime;  //!< The delay time in microseconds.
+    };
+
+    virtual void record(uint8_t data, bool rsValue, bool only4bits,
+        uint16_t delayTime);
+
+    /*! Returns the number of transfers in the buffer. */
+    uint16_t length() const
+    {
+        return count;
+    }
+
+    /*! Returns the number of transfers that were replaced by newer ones
+     * since the last call to clear(). */
+    uint32_t dropped() const
+    {
+        return droppedCount;
+    }
+
+    /*! Returns a transfer, with index 0 being the oldest one in the buffer.
+     * The index must be less than length(). */
+    Entry get(uint16_t index) const;
+
+    /*! Removes all the transfers from the buffer. */
+    void clear()
+    {
+        start = 0;
+        count = 0;
+        droppedCount = 0;
+    }
+
+    /*! Passes every transfer in the buffer to another sink, oldest first.
+     * This is how you feed a recorded trace to a
+     * PololuHD44780TraceAnalyzer. */
+    void replay(PololuHD44780TraceSink & sink) const;
+
+protected:
+
+    PololuHD44780TraceRing(uint8_t * storage, uint16_t maxLength)
+    {
+        this->storage = storage;
+        this->maxLength = maxLength;
+        clear();
+    }
+
+private:
+    static const uint8_t entrySize = 3;
+    static const uint16_t rsBit = 0x8000;
+    static const uint16_t only4bitBit = 0x4000;
+    static const uint16_t maxDelay = 0x3FFF;
+
+    uint8_t * storage;
+    uint16_t maxLength;
+
+    /* The index of the oldest entry. */
+    uint16_t start;
+    uint16_t count;
+
+    uint32_t droppedCount;
+};
+
+/*! \brief A PololuHD44780TraceRing with storage for a fixed number of
+ * transfers.
+ *
+ * @tparam traceLength The number of transfers the buffer can hold.  Each one
+ *   takes 3 bytes of RAM. */
+template <uint16_t traceLength> class PololuHD44780TraceBuffer :
+    public PololuHD44780TraceRing
+{
+public:
+    PololuHD44780TraceBuffer() : PololuHD44780TraceRing(storage, traceLength)
+    {
+    }
+
+private:
+    uint8_t storage[traceLength * 3];
+};
+
+/*! \brief Finds transfers that did not change anything on the LCD.
+ *
+ * This class runs each transfer it receives through a PololuHD44780Model and
+ * checks whether the transfer was needed.  It counts how many times each kind
+ * of unnecessary transfer happened and how many microseconds of delay they
+ * cost, according to the delay times in the trace.
+ *
+ * You can pass an analyzer to PololuHD44780Base::enableTrace() to check
+ * transfers as they happen, or record them with a PololuHD44780TraceBuffer
+ * and call PololuHD44780TraceRing::replay() later.  Since the model only
+ * needs the `Print` class and a few functions from the Arduino core, this
+ * class can also be compiled on a computer to analyze a trace copied from
+ * the device.  It uses about 220 bytes of RAM.
+ *
+ * The analyzer does not assume anything about the LCD's state until the
+ * trace sets it.  For example, it only reports rewrites of identical
+ * characters after it has seen the screen get cleared, so a trace that starts
+ * with the initialization sequence or a clear gives the most results. */
+class PololuHD44780TraceAnalyzer : public PololuHD44780TraceSink
+{
+public:
+    /*! The kinds of unnecessary transfers. */
+    enum Kind
+    {
+        /*! A "Set DDRAM address" or "Set CGRAM address" command that set the
+         * address counter to the value it already had. */
+        redundantAddress,
+
+        /*! A character written over the same character. */
+        identicalData,
+
+        /*! A "Display on/off control" command that did not change the
+         * display, cursor, or blinking settings. */
+        unchangedDisplayControl,
+
+        /*! An "Entry mode set" command that did not change the entry mode. */
+        unchangedEntryMode,
+
+        /*! A "Clear display" command that took longer than overwriting the
+         * characters on the screen with spaces would have, the way
+         * PololuHD44780Base::fastClear() does. */
+        avoidableClear,
+
+        /*! The number of kinds. */
+        kindCount,
+    };
+
+    /*! The number of times one kind of unnecessary transfer happened and the
+     * time it wasted. */
+    struct Waste
+    {
+        uint16_t count;  //!< The number of transfers.
+        uint32_t time;   //!< The total delay time in microseconds.
+    };
+
+    /*! Creates a new analyzer.
+     *
+     * @param timing The execution times used to estimate how long the
+     *   alternative to a clear command would take. */
+    PololuHD44780TraceAnalyzer(
+        const PololuHD44780Timing & timing = PololuHD44780Timing())
+    {
+        this->timing = timing;
+        reset();
+    }
+
+    virtual void record(uint8_t data, bool rsValue, bool only4bits,
+        uint16_t delayTime);
+
+    /*! Forgets everything it knows about the LCD and sets all the counts to
+     * zero. */
+    void reset();
+
+    /*! Prints the totals and each kind of unnecessary transfer, one per
+     * line. */
+    void printReport(Print & out) const;
+
+    /*! Returns a short name for a kind of unnecessary transfer. */
+    static const __FlashStringHelper * kindName(uint8_t kind);
+
+    /*! The number of transfers analyzed. */
+    uint32_t transfers;
+
+    /*! The total delay time of the transfers analyzed, in microseconds. */
+    uint32_t totalTime;
+
+    /*! The unnecessary transfers of each kind. */
+    Waste waste[kindCount];
+
+    /*! The model of the LCD, which has the state the trace left it in. */
+    PololuHD44780Model model;
+
+private:
+    void analyzeCommand(uint8_t cmd, uint16_t delayTime);
+    void analyzeData(uint8_t data, uint16_t delayTime);
+    uint16_t overwriteTime() const;
+    void addWaste(uint8_t kind, uint16_t time);
+
+    PololuHD44780Timing timing;
+
+    /* True if the LCD uses its 8-bit interface, so each byte is one bus
+     * cycle. */
+    bool eightBitBus;
+
+    /* Which parts of the model's state have been set by the trace. */
+    bool addressKnown;
+    bool ddramKnown;
+    bool displayControlKnown;
+    bool entryModeKnown;
+};
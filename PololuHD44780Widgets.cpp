@@ -0,0 +1,266 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+#include <PololuHD44780Widgets.h>
+
+// The LCD's built-in character with every dot on.
+static const uint8_t fullBlock = 0xFF;
+
+// Partly filled cells of a horizontal bar, with 1 to 4 columns on.
+static const uint8_t horizontalGlyphs[4 * 8] PROGMEM = {
+    0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000,
+    0b11000, 0b11000, 0b11000, 0b11000, 0b11000, 0b11000, 0b11000, 0b11000,
+    0b11100, 0b11100, 0b11100, 0b11100, 0b11100, 0b11100, 0b11100, 0b11100,
+    0b11110, 0b11110, 0b11110, 0b11110, 0b11110, 0b11110, 0b11110, 0b11110,
+};
+
+// Partly filled cells of a vertical bar, with 1 to 7 rows on.
+static const uint8_t verticalGlyphs[7 * 8] PROGMEM = {
+    0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b11111,
+    0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b11111, 0b11111,
+    0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b11111, 0b11111, 0b11111,
+    0b00000, 0b00000, 0b00000, 0b00000, 0b11111, 0b11111, 0b11111, 0b11111,
+    0b00000, 0b00000, 0b00000, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111,
+    0b00000, 0b00000, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111,
+    0b00000, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111,
+};
+
+PololuHD44780BarGraph::PololuHD44780BarGraph(PololuHD44780Base & lcd,
+    PololuHD44780GlyphCache & glyphs, uint8_t x, uint8_t y, uint8_t length,
+    uint8_t direction)
+{
+    this->lcd = &lcd;
+    this->glyphs = &glyphs;
+    this->x = x;
+    this->y = y;
+    if (length > 40) { length = 40; }
+
+    // A vertical bar grows upwards from row y, so it cannot go past row 0.
+    if (direction == vertical && length > y + 1) { length = y + 1; }
+
+    this->length = length;
+    this->direction = direction;
+    acquired = false;
+    level = 0;
+    known = false;
+}
+
+void PololuHD44780BarGraph::acquireGlyphs()
+{
+    uint8_t partials = cellLevels() - 1;
+    const uint8_t * pictures = direction == vertical ?
+        verticalGlyphs : horizontalGlyphs;
+    uint16_t id = firstGlyphId + (direction == vertical ? 8 : 0);
+    for (uint8_t i = 0; i < partials; i++)
+    {
+        codes[i] = glyphs->acquire(id + i, pictures + i * 8);
+    }
+    acquired = true;
+}
+
+void PololuHD44780BarGraph::release()
+{
+    if (!acquired) { return; }
+    uint8_t partials = cellLevels() - 1;
+    uint16_t id = firstGlyphId + (direction == vertical ? 8 : 0);
+    for (uint8_t i = 0; i < partials; i++)
+    {
+        if (codes[i] != PololuHD44780GlyphCache::noSlot)
+        {
+            glyphs->release(id + i);
+        }
+    }
+    acquired = false;
+
+    // The slots might be reused, which would change the cells on the screen.
+    known = false;
+}
+
+// Returns the character code for one cell of the bar at the specified level.
+uint8_t PololuHD44780BarGraph::cellCode(uint8_t cell, uint16_t level)
+{
+    uint16_t start = cell * cellLevels();
+    if (level <= start) { return ' '; }
+    uint16_t fill = level - start;
+    if (fill >= cellLevels()) { return fullBlock; }
+    uint8_t code = codes[fill - 1];
+    return code == PololuHD44780GlyphCache::noSlot ? ' ' : code;
+}
+
+void PololuHD44780BarGraph::show(uint16_t value, uint16_t maxValue)
+{
+    if (value > maxValue) { value = maxValue; }
+    showLevel(maxValue ? (uint32_t)value * maxLevel() / maxValue : 0);
+}
+
+void PololuHD44780BarGraph::showLevel(uint16_t newLevel)
+{
+    if (length == 0) { return; }
+    if (newLevel > maxLevel()) { newLevel = maxLevel(); }
+    if (!acquired) { acquireGlyphs(); }
+
+    // Only the cells between the old and new ends of the bar can change.
+    uint8_t first = 0;
+    uint8_t last = length - 1;
+    if (known)
+    {
+        if (newLevel == level) { return; }
+        uint16_t low = newLevel < level ? newLevel : level;
+        uint16_t high = newLevel < level ? level : newLevel;
+        first = low / cellLevels();
+        last = (high - 1) / cellLevels();
+    }
+
+    if (direction == horizontal)
+    {
+        uint8_t cells[40];
+        for (uint8_t i = first; i <= last; i++)
+        {
+            cells[i - first] = cellCode(i, newLevel);
+        }
+        lcd->gotoXY(x + first, y);
+        lcd->write(cells, last - first + 1);
+    }
+    else
+    {
+        for (uint8_t i = first; i <= last; i++)
+        {
+            lcd->gotoXY(x, y - i);
+            lcd->write(cellCode(i, newLevel));
+        }
+    }
+
+    level = newLevel;
+    known = true;
+}
+
+// Custom characters for big digits: a bar at the top, a bar at the bottom,
+// and both.
+static const uint8_t bigDigitGlyphs[3 * 8] PROGMEM = {
+    0b11111, 0b11111, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000,
+    0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b11111, 0b11111,
+    0b11111, 0b11111, 0b00000, 0b00000, 0b00000, 0b00000, 0b11111, 0b11111,
+};
+
+// The shapes of the 6 cells of each digit and the blank position: the top
+// row from left to right, then the bottom row.  '#' is a full block, 'T' is
+// a bar at the top, 'L' is a bar at the bottom, and 'M' is both.
+static const char bigDigitShapes[11][7] PROGMEM = {
+    "#T##L#",  // 0
+    "T# L#L",  // 1
+    "MM##LL",  // 2
+    "TM#LL#",  // 3
+    "#L#  #",  // 4
+    "#MMLL#",  // 5
+    "#MM#L#",  // 6
+    "TT#  #",  // 7
+    "#M##L#",  // 8
+    "#M#LL#",  // 9
+    "      ",  // blank
+};
+
+PololuHD44780BigDigits::PololuHD44780BigDigits(PololuHD44780Base & lcd,
+    PololuHD44780GlyphCache & glyphs, uint8_t x, uint8_t y, uint8_t count,
+    uint8_t spacing)
+{
+    this->lcd = &lcd;
+    this->glyphs = &glyphs;
+    this->x = x;
+    this->y = y;
+    this->count = count > maxDigits ? maxDigits : count;
+    this->spacing = spacing;
+    acquired = false;
+    invalidate();
+}
+
+void PololuHD44780BigDigits::invalidate()
+{
+    memset(shown, 0xFF, sizeof(shown));
+}
+
+void PololuHD44780BigDigits::acquireGlyphs()
+{
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        codes[i] = glyphs->acquire(firstGlyphId + i, bigDigitGlyphs + i * 8);
+    }
+    acquired = true;
+}
+
+void PololuHD44780BigDigits::release()
+{
+    if (!acquired) { return; }
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        if (codes[i] != PololuHD44780GlyphCache::noSlot)
+        {
+            glyphs->release(firstGlyphId + i);
+        }
+    }
+    acquired = false;
+    invalidate();
+}
+
+// Returns the character code for a shape from bigDigitShapes.
+uint8_t PololuHD44780BigDigits::cellCode(uint8_t shape)
+{
+    uint8_t code;
+    switch (shape)
+    {
+    case '#': return fullBlock;
+    case 'T': code = codes[0]; break;
+    case 'L': code = codes[1]; break;
+    case 'M': code = codes[2]; break;
+    default: return ' ';
+    }
+    return code == PololuHD44780GlyphCache::noSlot ? ' ' : code;
+}
+
+void PololuHD44780BigDigits::showDigit(uint8_t position, uint8_t digit)
+{
+    if (position >= count) { return; }
+    if (digit > blank) { digit = blank; }
+    if (!acquired) { acquireGlyphs(); }
+
+    uint8_t old = shown[position];
+    if (old == digit) { return; }
+
+    uint8_t left = x + position * (3 + spacing);
+    for (uint8_t row = 0; row < 2; row++)
+    {
+        // Rewrite the cells from the first one that changed to the last one,
+        // which costs at most one unchanged cell.
+        uint8_t cells[3];
+        int8_t first = -1, last = -1;
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            uint8_t shape = pgm_read_byte(&bigDigitShapes[digit][row * 3 + i]);
+            cells[i] = cellCode(shape);
+            if (old <= blank &&
+                pgm_read_byte(&bigDigitShapes[old][row * 3 + i]) == shape)
+            {
+                continue;
+            }
+            if (first < 0) { first = i; }
+            last = i;
+        }
+
+        if (first >= 0)
+        {
+            lcd->gotoXY(left + first, y + row);
+            lcd->write(cells + first, last - first + 1);
+        }
+    }
+
+    shown[position] = digit;
+}
+
+void PololuHD44780BigDigits::show(unsigned long value)
+{
+    for (int8_t position = count - 1; position >= 0; position--)
+    {
+        // The rightmost position shows 0 if the value is 0.
+        bool leading = value == 0 && position != count - 1;
+        showDigit(position, leading ? blank : value % 10);
+        value /= 10;
+    }
+}
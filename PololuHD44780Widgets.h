@@ -0,0 +1,207 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+/*! \file PololuHD44780Widgets.h
+ *
+ * This header defines bar graphs and big digits drawn with custom
+ * characters. */
+
+#pragma once
+#include <PololuHD44780.h>
+#include <PololuHD44780GlyphCache.h>
+
+/*! \brief A horizontal or vertical bar graph.
+ *
+ * The bar is drawn with the LCD's built-in full block character (0xFF) and
+ * custom characters for the partly filled cell at its end: 4 of them for a
+ * horizontal bar, which can end at any of the 5 columns of dots in a cell,
+ * or 7 for a vertical bar, which can end at any of the 8 rows.  The custom
+ * characters are loaded through a PololuHD44780GlyphCache the first time the
+ * bar is shown, so bar graphs of the same direction share them and they are
+ * only uploaded once.  If the cache runs out of slots, the partly filled
+ * cell is shown as empty.
+ *
+ * The bar graph remembers how full it is, so each update only rewrites the
+ * cells between the old end of the bar and the new one, which is usually
+ * just one or two characters.
+ *
+ * Example:
+ *
+ * ~~~{.cpp}
+ * PololuHD44780GlyphCache glyphs(lcd);
+ * PololuHD44780BarGraph bar(lcd, glyphs, 0, 1, 16);
+ *
+ * void loop()
+ * {
+ *     bar.show(analogRead(A0), 1023);
+ * }
+ * ~~~
+ *
+ * This class writes to the LCD with PololuHD44780Base::gotoXY() and
+ * PololuHD44780Base::write(), so the LCD should be in left-to-right mode.
+ * If something else writes over the bar, for example if the LCD is cleared,
+ * call invalidate(). */
+class PololuHD44780BarGraph
+{
+public:
+    /*! Values for the direction of a bar graph. */
+    enum Direction
+    {
+        horizontal,  //!< The bar grows to the right.
+        vertical,    //!< The bar grows upwards.
+    };
+
+    /*! The first glyph ID used in the glyph cache.  Bar graphs use the IDs
+     * from this one to this one plus 15. */
+    static const uint16_t firstGlyphId = 0xFE00;
+
+    /*! Creates a new bar graph.
+     *
+     * @param lcd The LCD to draw on.
+     * @param glyphs The glyph cache to load the custom characters with.
+     * @param x The column of the leftmost cell (for a horizontal bar) or of
+     *   the bar (for a vertical bar).
+     * @param y The row of the bar (for a horizontal bar) or of the bottom
+     *   cell (for a vertical bar).
+     * @param length The number of cells in the bar, up to 40.  A vertical
+     *   bar is limited to the rows from `y` up to the top of the screen.
+     * @param direction PololuHD44780BarGraph::horizontal or
+     *   PololuHD44780BarGraph::vertical. */
+    PololuHD44780BarGraph(PololuHD44780Base & lcd,
+        PololuHD44780GlyphCache & glyphs, uint8_t x, uint8_t y,
+        uint8_t length, uint8_t direction = horizontal);
+
+    /*! Shows a value as a fraction of the maximum, rounded down to the
+     * nearest column (or row) of dots. */
+    void show(uint16_t value, uint16_t maxValue);
+
+    /*! Fills the specified number of columns (or rows) of dots, from 0 to
+     * maxLevel(). */
+    void showLevel(uint16_t level);
+
+    /*! Returns the number of columns (or rows) of dots in the whole bar. */
+    uint16_t maxLevel() const
+    {
+        return length * cellLevels();
+    }
+
+    /*! Makes the next update rewrite every cell of the bar. */
+    void invalidate()
+    {
+        known = false;
+    }
+
+    /*! Releases the bar's custom characters in the glyph cache, so their
+     * slots can be used for other glyphs once no other bar graph is using
+     * them.  They are acquired again the next time the bar is shown. */
+    void release();
+
+private:
+    uint8_t cellLevels() const
+    {
+        return direction == vertical ? 8 : 5;
+    }
+
+    void acquireGlyphs();
+    uint8_t cellCode(uint8_t cell, uint16_t level);
+
+    PololuHD44780Base * lcd;
+    PololuHD44780GlyphCache * glyphs;
+    uint8_t x, y;
+    uint8_t length;
+    uint8_t direction;
+
+    /* The character codes of the partly filled cells, or
+     * PololuHD44780GlyphCache::noSlot. */
+    uint8_t codes[7];
+    bool acquired;
+
+    /* The level shown, if known is true. */
+    uint16_t level;
+    bool known;
+};
+
+/*! \brief Large digits that are 3 characters wide and 2 characters tall.
+ *
+ * The digits are drawn with the LCD's built-in full block character (0xFF)
+ * and three custom characters: a bar at the top of the cell, a bar at the
+ * bottom, and both.  The custom characters are loaded through a
+ * PololuHD44780GlyphCache the first time a digit is shown, so all the big
+ * digit objects share them and they are only uploaded once.
+ *
+ * Each digit takes 3 columns, and there is a gap between digits.  When a
+ * digit changes, only the cells that look different are rewritten.  For
+ * example, changing an 8 to a 9 rewrites one cell.
+ *
+ * Example:
+ *
+ * ~~~{.cpp}
+ * PololuHD44780GlyphCache glyphs(lcd);
+ * PololuHD44780BigDigits clock(lcd, glyphs, 0, 0, 4);
+ *
+ * clock.show(1234);
+ * ~~~
+ *
+ * Like PololuHD44780BarGraph, this class expects the LCD to be in
+ * left-to-right mode, and you should call invalidate() after something else
+ * writes over the digits. */
+class PololuHD44780BigDigits
+{
+public:
+    /*! The maximum number of digits. */
+    static const uint8_t maxDigits = 10;
+
+    /*! The value to pass to showDigit() for a blank position. */
+    static const uint8_t blank = 10;
+
+    /*! The first glyph ID used in the glyph cache.  Big digits use the IDs
+     * from this one to this one plus 15. */
+    static const uint16_t firstGlyphId = 0xFE10;
+
+    /*! Creates a new object for showing big digits.
+     *
+     * @param lcd The LCD to draw on.
+     * @param glyphs The glyph cache to load the custom characters with.
+     * @param x The column of the leftmost digit's left edge.
+     * @param y The row of the top half of the digits.
+     * @param count The number of digits, up to maxDigits.
+     * @param spacing The number of columns between digits. */
+    PololuHD44780BigDigits(PololuHD44780Base & lcd,
+        PololuHD44780GlyphCache & glyphs, uint8_t x, uint8_t y,
+        uint8_t count, uint8_t spacing = 1);
+
+    /*! Shows a number, right-aligned, with blanks instead of leading zeros.
+     * If the number has more digits than there are positions, only the
+     * lowest digits are shown. */
+    void show(unsigned long value);
+
+    /*! Shows one digit.
+     *
+     * @param position The position, with 0 being the leftmost.
+     * @param digit A digit from 0 to 9, or blank. */
+    void showDigit(uint8_t position, uint8_t digit);
+
+    /*! Makes the next update rewrite every cell of every digit. */
+    void invalidate();
+
+    /*! Releases the custom characters in the glyph cache.  They are acquired
+     * again the next time a digit is shown. */
+    void release();
+
+private:
+    void acquireGlyphs();
+    uint8_t cellCode(uint8_t shape);
+
+    PololuHD44780Base * lcd;
+    PololuHD44780GlyphCache * glyphs;
+    uint8_t x, y;
+    uint8_t count;
+    uint8_t spacing;
+
+    /* The character codes of the custom characters, or
+     * PololuHD44780GlyphCache::noSlot. */
+    uint8_t codes[3];
+    bool acquired;
+
+    /* The digit shown at each position, or 0xFF if unknown. */
+    uint8_t shown[maxDigits];
+};
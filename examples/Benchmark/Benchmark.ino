@@ -0,0 +1,245 @@
+/* This program measures how long common LCD operations take and
+how many commands and data bytes they send.  It does not need an
+LCD: it uses a PololuHD44780Emulator, which runs the same code
+and delays as a real LCD would but sends everything to a model of
+the HD44780 controller instead.
+
+For each workload, the program prints one line to the serial
+monitor with these columns:
+
+- modeled: microseconds the HD44780 would need to execute the
+  commands and data, according to its datasheet, as counted by
+  the model's clock
+- per_char: modeled time divided by the characters the workload
+  is meant to display
+- cmd: number of commands sent
+- data: number of data bytes sent
+- cycles: number of E pulses
+- blocking: microseconds spent inside the library, measured with
+  micros()
+
+The first five columns only depend on what the library sends, so
+they are the same on every board and are the ones to compare.
+The blocking time also includes the library's delays and the
+speed of the processor.  The program can also run on a PC as part
+of the host build in the tests directory, where micros() is a
+virtual clock and every column is repeatable.
+
+The output is always in the same order, so you can save it and
+compare it against the output from a different version of the
+library to look for regressions. */
+
+#include <PololuHD44780.h>
+#include <PololuHD44780Marquee.h>
+#include <PololuHD44780Model.h>
+#include <PololuHD44780Widgets.h>
+
+PololuHD44780Emulator lcd;
+PololuHD44780FieldBuffer<4> counter(10, 1);
+PololuHD44780Marquee ticker(lcd, 16);
+PololuHD44780GlyphCache glyphCache(lcd);
+PololuHD44780BarGraph bar(lcd, glyphCache, 0, 1, 16);
+
+const uint8_t glyphs[64] PROGMEM = {
+  0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b11111,
+  0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b11111, 0b11111,
+  0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b11111, 0b11111, 0b11111,
+  0b00000, 0b00000, 0b00000, 0b00000, 0b11111, 0b11111, 0b11111, 0b11111,
+  0b00000, 0b00000, 0b00000, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111,
+  0b00000, 0b00000, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111,
+  0b00000, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111,
+  0b11111, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111,
+};
+
+const char marquee[] = "Pololu HD44780 benchmark marquee text... ";
+
+uint32_t startTime;
+
+void startWorkload()
+{
+  lcd.model.resetCounters();
+  startTime = micros();
+}
+
+void reportWorkload(const char * name, uint16_t characters)
+{
+  uint32_t blocking = micros() - startTime;
+  uint32_t modeled = lcd.model.busyTime();
+
+  Serial.print(name);
+  Serial.print(F(": modeled="));
+  Serial.print(modeled);
+  Serial.print(F(" per_char="));
+  Serial.print(characters ? modeled / characters : 0);
+  Serial.print(F(" cmd="));
+  Serial.print(lcd.model.commandCount());
+  Serial.print(F(" data="));
+  Serial.print(lcd.model.dataCount());
+  Serial.print(F(" cycles="));
+  Serial.print(lcd.model.busCycleCount());
+  Serial.print(F(" blocking="));
+  Serial.println(blocking);
+}
+
+void fullRedraw()
+{
+  lcd.clear();
+  for (uint8_t y = 0; y < 4; y++)
+  {
+    lcd.gotoXY(0, y);
+    lcd.print(F("Line "));
+    lcd.print(y);
+    lcd.print(F(": 0123456789ab"));
+  }
+}
+
+void setup()
+{
+  Serial.begin(115200);
+
+  // Initialize the LCD outside of the measurements.
+  lcd.init();
+
+  startWorkload();
+  lcd.clear();
+  reportWorkload("clear", 0);
+
+  startWorkload();
+  lcd.home();
+  reportWorkload("home", 0);
+
+  startWorkload();
+  lcd.gotoXY(5, 1);
+  reportWorkload("gotoXY", 0);
+
+  startWorkload();
+  lcd.write((const uint8_t *)"01234567890123456789", 20);
+  reportWorkload("write_20", 20);
+
+  startWorkload();
+  lcd.loadCustomCharacter(glyphs, 0);
+  reportWorkload("loadCustomCharacter", 0);
+
+  startWorkload();
+  for (uint8_t i = 0; i < 8; i++)
+  {
+    lcd.loadCustomCharacter(glyphs + i * 8, i);
+  }
+  reportWorkload("glyph_reload_8", 0);
+
+  startWorkload();
+  lcd.loadCustomCharacters(glyphs);
+  reportWorkload("glyph_table_8", 0);
+
+  startWorkload();
+  fullRedraw();
+  reportWorkload("full_redraw_20x4", 80);
+
+  startWorkload();
+  for (uint16_t i = 0; i < 10; i++)
+  {
+    lcd.gotoXY(10, 1);
+    lcd.print(1000 + i * 7);
+  }
+  reportWorkload("field_update_x10", 40);
+
+  startWorkload();
+  for (uint16_t i = 0; i < 10; i++)
+  {
+    lcd.printField(counter, 1000 + i * 7);
+  }
+  reportWorkload("field_widget_x10", 40);
+
+  bar.showLevel(40);
+  startWorkload();
+  for (uint8_t i = 1; i <= 10; i++)
+  {
+    bar.showLevel(40 + i);
+  }
+  reportWorkload("bar_graph_step_x10", 10);
+
+  startWorkload();
+  for (uint8_t step = 0; step < 10; step++)
+  {
+    lcd.gotoXY(0, 0);
+    for (uint8_t x = 0; x < 16; x++)
+    {
+      lcd.write(marquee[(step + x) % (sizeof(marquee) - 1)]);
+    }
+  }
+  reportWorkload("marquee_rewrite_x10", 160);
+
+  ticker.setScrolling(0, marquee);
+  ticker.begin();
+  startWorkload();
+  for (uint8_t step = 0; step < 10; step++)
+  {
+    ticker.scrollLeft();
+  }
+  reportWorkload("marquee_shift_x10", 160);
+  ticker.release(0);
+  lcd.fastHome();
+
+  startWorkload();
+  for (uint8_t step = 0; step < 10; step++)
+  {
+    lcd.scrollDisplayLeft();
+  }
+  reportWorkload("scroll_left_x10", 0);
+
+  startWorkload();
+  lcd.fastHome();
+  reportWorkload("fast_home_shift_10", 0);
+
+  lcd.clear();
+  lcd.print(F("0123456789abcdef"));
+  lcd.gotoXY(0, 1);
+  lcd.print(F("0123456789abcdef"));
+  startWorkload();
+  lcd.fastClear();
+  reportWorkload("fast_clear_16x2", 0);
+
+  fullRedraw();
+  startWorkload();
+  lcd.fastClear();
+  reportWorkload("fast_clear_20x4", 0);
+
+  startWorkload();
+  for (uint8_t i = 0; i < 10; i++)
+  {
+    lcd.noDisplay();
+    lcd.hideCursor();
+    lcd.gotoXY(0, 0);
+    lcd.print(F("mode"));
+    lcd.display();
+  }
+  reportWorkload("mode_changes_x10", 40);
+
+  startWorkload();
+  for (uint8_t i = 0; i < 10; i++)
+  {
+    lcd.beginUpdate();
+    lcd.noDisplay();
+    lcd.hideCursor();
+    lcd.gotoXY(0, 0);
+    lcd.print(F("mode"));
+    lcd.display();
+    lcd.endUpdate();
+  }
+  reportWorkload("mode_changes_batched_x10", 40);
+
+  lcd.setGeometry(PololuHD44780Geometry(20, 4));
+  lcd.clear();
+  startWorkload();
+  for (uint8_t i = 0; i < 4; i++)
+  {
+    lcd.print(F("01234567890123456789"));
+  }
+  reportWorkload("wrapped_write_20x4", 80);
+
+  Serial.println(F("done"));
+}
+
+void loop()
+{
+}
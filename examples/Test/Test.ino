@@ -193,6 +193,11 @@ void loop()
   lcd.print("klmn");
   wait(160);
 
+  // Test fastClear().  The screen should be empty except for a
+  // blinking cursor in the upper left.
+  lcd.fastClear();
+  wait(165);
+
   // Test that the screen can really hold 40 characters on each
   // line, and that it can display the last 4 columns with the
   // first 4 columns.
@@ -208,4 +213,11 @@ void loop()
   lcd.scrollDisplayRight();
   lcd.scrollDisplayRight();
   wait(170);
+
+  // Test fastHome().
+  // Expected screen: "abcdefgh"
+  //                  "ABCDEFGH"
+  // (with a blinking cursor over the a)
+  lcd.fastHome();
+  wait(180);
 }
@@ -0,0 +1,57 @@
+/* This example shows how to find out what your program sends to
+the LCD and which of those transfers were not needed.
+
+It redraws a small status screen the simple way, by clearing the
+LCD and printing everything again, and passes every transfer to a
+PololuHD44780TraceAnalyzer.  Every few seconds, it prints a report
+to the serial monitor at 115200 baud, like this:
+
+  transfers=1234 time=98765
+  redundant_address: count=0 time=0
+  identical_data: count=300 time=11100
+  ...
+
+Each line after the first says how many transfers of that kind
+did not change anything on the LCD, and how many microseconds the
+library spent waiting for them.  You can use this to decide where
+functions like fastClear(), printField(), or framebuffer mode
+would help.
+
+To record transfers without analyzing them right away, pass a
+PololuHD44780TraceBuffer to enableTrace() instead and call its
+replay() function later. */
+
+#include <PololuHD44780.h>
+#include <PololuHD44780Trace.h>
+
+PololuHD44780 lcd(7, 6, 5, 4, 3, 2);
+
+PololuHD44780TraceAnalyzer analyzer;
+
+void setup()
+{
+  Serial.begin(115200);
+
+  // Start analyzing before the LCD is initialized, so the analyzer
+  // knows what state the LCD is in.
+  lcd.enableTrace(analyzer);
+}
+
+void loop()
+{
+  static uint16_t lastReportTime;
+
+  lcd.clear();
+  lcd.print(F("Uptime:"));
+  lcd.gotoXY(0, 1);
+  lcd.print(millis() / 1000);
+  lcd.display();
+  delay(100);
+
+  if ((uint16_t)(millis() - lastReportTime) >= 5000)
+  {
+    analyzer.printReport(Serial);
+    Serial.println();
+    lastReportTime = millis();
+  }
+}
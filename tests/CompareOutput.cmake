@@ -0,0 +1,18 @@
+# Runs PROGRAM and fails if its output differs from the contents of EXPECTED.
+# Usage: cmake -DPROGRAM=<path> -DEXPECTED=<path> -P CompareOutput.cmake
+
+execute_process(
+  COMMAND ${PROGRAM}
+  OUTPUT_VARIABLE actual
+  RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "${PROGRAM} exited with ${result}")
+endif()
+
+file(READ ${EXPECTED} expected)
+if(NOT actual STREQUAL expected)
+  message("Expected:\n${expected}")
+  message("Actual:\n${actual}")
+  message(FATAL_ERROR "The output of ${PROGRAM} does not match ${EXPECTED}.")
+endif()
@@ -0,0 +1,14 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+// Runs the Benchmark example on the PC, where micros() is the virtual clock,
+// so its whole output is the same on every run.
+
+#include <Arduino.h>
+#include "../examples/Benchmark/Benchmark.ino"
+
+int main()
+{
+    setup();
+    loop();
+    return 0;
+}
@@ -0,0 +1,72 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+#include <Arduino.h>
+
+static uint32_t now;
+static HostPinHandler * pinHandler;
+
+HostSerial Serial;
+
+// Reading the clock or a pin takes 1 us of virtual time, so code that polls
+// them in a loop always makes progress.
+unsigned long micros()
+{
+    return now++;
+}
+
+unsigned long millis()
+{
+    return now / 1000;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    now += us;
+}
+
+void delay(unsigned long ms)
+{
+    now += ms * 1000;
+}
+
+uint32_t hostTime()
+{
+    return now;
+}
+
+void hostAdvance(uint32_t us)
+{
+    now += us;
+}
+
+void hostResetTime()
+{
+    now = 0;
+}
+
+void hostSetPinHandler(HostPinHandler * handler)
+{
+    pinHandler = handler;
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (pinHandler) { pinHandler->pinMode(pin, mode); }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    if (pinHandler) { pinHandler->digitalWrite(pin, value ? HIGH : LOW); }
+}
+
+int digitalRead(uint8_t pin)
+{
+    now++;
+    return pinHandler ? pinHandler->digitalRead(pin) : LOW;
+}
+
+size_t HostSerial::write(uint8_t c)
+{
+    if (c != '\r') { putchar(c); }
+    return 1;
+}
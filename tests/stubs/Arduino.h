@@ -0,0 +1,139 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+/* A minimal stand-in for the Arduino core, so that the library can be compiled
+ * and tested on a PC.
+ *
+ * Time is simulated by a virtual clock that only moves when the code under
+ * test delays or reads it, so test results do not depend on the speed of the
+ * computer.  Pin writes and reads can be routed to a simulated circuit with
+ * hostSetPinHandler(). */
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+
+class __FlashStringHelper;
+#define F(s) ((const __FlashStringHelper *)(s))
+
+typedef uint8_t byte;
+typedef uint16_t word;
+
+/* Virtual clock */
+
+unsigned long micros();
+unsigned long millis();
+void delayMicroseconds(unsigned int us);
+void delay(unsigned long ms);
+
+/* Host-only: returns the virtual time in microseconds without advancing it. */
+uint32_t hostTime();
+
+/* Host-only: moves the virtual clock forward. */
+void hostAdvance(uint32_t us);
+
+/* Host-only: sets the virtual clock back to 0. */
+void hostResetTime();
+
+/* Pins */
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+/* Host-only: receives every pin write and read.  With no handler, writes are
+ * ignored and reads return LOW. */
+class HostPinHandler
+{
+public:
+    virtual ~HostPinHandler() {}
+    virtual void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
+    virtual void digitalWrite(uint8_t pin, uint8_t value) = 0;
+    virtual int digitalRead(uint8_t pin) = 0;
+};
+
+void hostSetPinHandler(HostPinHandler * handler);
+
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+class Print
+{
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t c) = 0;
+
+    virtual size_t write(const uint8_t * buffer, size_t size)
+    {
+        size_t n = 0;
+        while (size--) { n += write(*buffer++); }
+        return n;
+    }
+
+    size_t write(const char * str)
+    {
+        return str ? write((const uint8_t *)str, strlen(str)) : 0;
+    }
+
+    size_t write(const char * buffer, size_t size)
+    {
+        return write((const uint8_t *)buffer, size);
+    }
+
+    size_t print(const __FlashStringHelper * str)
+    {
+        return write((const char *)str);
+    }
+
+    size_t print(const char * str) { return write(str); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char n) { return print((unsigned long)n); }
+    size_t print(int n) { return print((long)n); }
+    size_t print(unsigned int n) { return print((unsigned long)n); }
+
+    size_t print(long n)
+    {
+        char buffer[24];
+        snprintf(buffer, sizeof(buffer), "%ld", n);
+        return write(buffer);
+    }
+
+    size_t print(unsigned long n)
+    {
+        char buffer[24];
+        snprintf(buffer, sizeof(buffer), "%lu", n);
+        return write(buffer);
+    }
+
+    size_t println() { return write("\r\n"); }
+
+    template <class T> size_t println(T value)
+    {
+        size_t n = print(value);
+        return n + println();
+    }
+};
+
+/* Serial writes to standard output, without carriage returns. */
+class HostSerial : public Print
+{
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    virtual size_t write(uint8_t c);
+    using Print::write;
+    operator bool() { return true; }
+};
+
+extern HostSerial Serial;
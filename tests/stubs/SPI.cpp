@@ -0,0 +1,51 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+#include <SPI.h>
+
+static HostSpiHandler * spiHandler;
+
+SPIClass SPI;
+
+void hostSetSpiHandler(HostSpiHandler * handler)
+{
+    spiHandler = handler;
+}
+
+void SPIClass::beginTransaction(SPISettings settings)
+{
+    this->settings = settings;
+    hostInTransaction = true;
+    transactionStart = hostTime();
+}
+
+void SPIClass::endTransaction()
+{
+    hostInTransaction = false;
+    uint32_t time = hostTime() - transactionStart;
+    if (time > hostLongestTransaction) { hostLongestTransaction = time; }
+}
+
+uint8_t SPIClass::transfer(uint8_t value)
+{
+    if (!hostInTransaction) { hostStrayTransfers++; }
+    hostAdvance((8000000 + settings.clock - 1) / settings.clock);
+    return spiHandler ? spiHandler->transfer(value) : 0;
+}
+
+void SPIClass::transfer(void * buffer, size_t count)
+{
+    uint8_t * p = (uint8_t *)buffer;
+    while (count--)
+    {
+        *p = transfer(*p);
+        p++;
+    }
+}
+
+void SPIClass::hostReset()
+{
+    hostInTransaction = false;
+    hostStrayTransfers = 0;
+    hostLongestTransaction = 0;
+    transactionStart = 0;
+}
@@ -0,0 +1,72 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+/* A minimal stand-in for the Arduino SPI library.
+ *
+ * Each byte takes 8 clock periods at the speed in the current SPISettings and
+ * is passed to the handler set with hostSetSpiHandler().  The stub also
+ * records how the bus was used: transfers outside a transaction, and the
+ * longest time any transaction kept the bus. */
+
+#pragma once
+#include <Arduino.h>
+
+#define MSBFIRST 1
+#define LSBFIRST 0
+#define SPI_MODE0 0x00
+
+/* Host-only: receives every byte sent on the bus and returns the byte to
+ * read back. */
+class HostSpiHandler
+{
+public:
+    virtual ~HostSpiHandler() {}
+    virtual uint8_t transfer(uint8_t value) = 0;
+};
+
+void hostSetSpiHandler(HostSpiHandler * handler);
+
+class SPISettings
+{
+public:
+    SPISettings(uint32_t clock = 4000000, uint8_t bitOrder = MSBFIRST,
+        uint8_t dataMode = SPI_MODE0)
+        : clock(clock), bitOrder(bitOrder), dataMode(dataMode) {}
+
+    uint32_t clock;
+    uint8_t bitOrder;
+    uint8_t dataMode;
+};
+
+class SPIClass
+{
+public:
+    SPIClass()
+    {
+        hostReset();
+    }
+
+    void begin() {}
+    void beginTransaction(SPISettings settings);
+    void endTransaction();
+    uint8_t transfer(uint8_t value);
+    void transfer(void * buffer, size_t count);
+
+    /* Host-only: ends any transaction and sets the counts below back to 0. */
+    void hostReset();
+
+    /* Host-only: true between beginTransaction() and endTransaction(). */
+    bool hostInTransaction;
+
+    /* Host-only: the number of bytes transferred outside a transaction. */
+    uint32_t hostStrayTransfers;
+
+    /* Host-only: the longest time from beginTransaction() to
+     * endTransaction(), in microseconds. */
+    uint32_t hostLongestTransaction;
+
+private:
+    SPISettings settings;
+    uint32_t transactionStart;
+};
+
+extern SPIClass SPI;
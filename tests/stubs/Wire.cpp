@@ -0,0 +1,29 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+#include <Wire.h>
+
+static HostWireHandler * wireHandler;
+
+TwoWire Wire;
+
+void hostSetWireHandler(HostWireHandler * handler)
+{
+    wireHandler = handler;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop)
+{
+    (void)sendStop;
+    if (overflowed) { return 1; }
+
+    // Deliver each byte when its last bit (and the acknowledgment) has been
+    // clocked out, starting after the address byte.
+    uint32_t start = hostTime();
+    for (uint8_t i = 0; i < length; i++)
+    {
+        uint32_t end = start + (uint64_t)(i + 2) * 9 * 1000000 / clock;
+        hostAdvance(end - hostTime());
+        if (wireHandler) { wireHandler->receive(address, buffer[i]); }
+    }
+    return 0;
+}
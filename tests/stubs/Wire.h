@@ -0,0 +1,62 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+/* A minimal stand-in for the Arduino Wire library.
+ *
+ * Transmissions take the time they would on a real bus at the clock set with
+ * setClock() (100 kHz by default), counting 9 bits for each byte including the
+ * address, and each byte is passed to the handler set with
+ * hostSetWireHandler() when its last bit has been sent.  Like the AVR Wire
+ * library, a transmission holds at most 32 bytes. */
+
+#pragma once
+#include <Arduino.h>
+
+/* Host-only: receives every byte written to an I2C device. */
+class HostWireHandler
+{
+public:
+    virtual ~HostWireHandler() {}
+    virtual void receive(uint8_t address, uint8_t value) = 0;
+};
+
+void hostSetWireHandler(HostWireHandler * handler);
+
+class TwoWire
+{
+public:
+    TwoWire() : clock(100000), address(0), length(0), overflowed(false) {}
+
+    void begin() {}
+    void setClock(uint32_t clock) { this->clock = clock; }
+
+    void beginTransmission(uint8_t address)
+    {
+        this->address = address;
+        length = 0;
+        overflowed = false;
+    }
+
+    size_t write(uint8_t value)
+    {
+        if (length == sizeof(buffer))
+        {
+            overflowed = true;
+            return 0;
+        }
+        buffer[length++] = value;
+        return 1;
+    }
+
+    /* Returns 1 if the data did not fit in the buffer, like the AVR library.
+     * Nothing is sent in that case. */
+    uint8_t endTransmission(bool sendStop = true);
+
+private:
+    uint32_t clock;
+    uint8_t address;
+    uint8_t buffer[32];
+    uint8_t length;
+    bool overflowed;
+};
+
+extern TwoWire Wire;
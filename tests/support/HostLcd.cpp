@@ -0,0 +1,118 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+#include "HostLcd.h"
+
+void HostLcd::reset()
+{
+    model.reset();
+    timingViolations = 0;
+    minimumBusyTime = 0;
+    busyUntil = hostTime();
+    lastE = false;
+    readLowNibble = false;
+    readValue = 0;
+    output = 0;
+}
+
+void HostLcd::setLines(bool rs, bool rw, bool e, uint8_t data)
+{
+    if (e && !lastE && rw)
+    {
+        // Start of a read.  In 4-bit mode, the whole byte is read on the
+        // first pulse and its lower nibble is output on the second one.
+        if (model.eightBitInterface() || !readLowNibble)
+        {
+            readValue = model.read(rs);
+            if (!rs && busy()) { readValue |= 0x80; }
+            output = readValue;
+        }
+        else
+        {
+            output = readValue << 4;
+        }
+        if (!model.eightBitInterface()) { readLowNibble = !readLowNibble; }
+    }
+    else if (!e && lastE && !rw)
+    {
+        if (busy()) { timingViolations++; }
+        uint32_t before = model.busyTime();
+        model.busCycle(data, rs);
+        uint32_t duration = model.busyTime() - before;
+        if (duration != 0 && duration < minimumBusyTime)
+        {
+            duration = minimumBusyTime;
+        }
+        busyUntil = hostTime() + duration;
+    }
+    lastE = e;
+}
+
+std::string screenText(const PololuHD44780Model & model, uint8_t x, uint8_t y,
+    uint8_t width)
+{
+    std::string s;
+    for (uint8_t i = 0; i < width; i++)
+    {
+        s += (char)model.characterAt(x + i, y);
+    }
+    return s;
+}
+
+HostLcdPins::HostLcdPins(HostLcd & lcd, uint8_t rs, uint8_t rw, uint8_t e,
+    uint8_t db4, uint8_t db5, uint8_t db6, uint8_t db7)
+{
+    this->lcd = &lcd;
+    this->rs = rs;
+    this->rw = rw;
+    this->e = e;
+    const uint8_t pins[8] = { 255, 255, 255, 255, db4, db5, db6, db7 };
+    memcpy(db, pins, sizeof(db));
+    memset(levels, 0, sizeof(levels));
+    hostSetPinHandler(this);
+}
+
+HostLcdPins::HostLcdPins(HostLcd & lcd, uint8_t rs, uint8_t e,
+    const uint8_t db[8])
+{
+    this->lcd = &lcd;
+    this->rs = rs;
+    this->rw = 255;
+    this->e = e;
+    memcpy(this->db, db, sizeof(this->db));
+    memset(levels, 0, sizeof(levels));
+    hostSetPinHandler(this);
+}
+
+HostLcdPins::~HostLcdPins()
+{
+    hostSetPinHandler(NULL);
+}
+
+void HostLcdPins::digitalWrite(uint8_t pin, uint8_t value)
+{
+    levels[pin] = value;
+    update();
+}
+
+int HostLcdPins::digitalRead(uint8_t pin)
+{
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        if (db[i] == pin && rw != 255 && levels[rw])
+        {
+            return lcd->dataOutput() >> i & 1;
+        }
+    }
+    return levels[pin];
+}
+
+void HostLcdPins::update()
+{
+    uint8_t data = 0;
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        if (db[i] != 255 && levels[db[i]]) { data |= 1 << i; }
+    }
+    bool rwLevel = rw != 255 && levels[rw];
+    lcd->setLines(levels[rs], rwLevel, levels[e], data);
+}
@@ -0,0 +1,103 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+/* Simulated LCD hardware for the tests. */
+
+#pragma once
+#include <Arduino.h>
+#include <PololuHD44780Model.h>
+#include <string>
+
+/* Returns the characters shown in part of a row of the screen, using the
+ * 20x4 layout of PololuHD44780Model::characterAt(). */
+std::string screenText(const PololuHD44780Model & model, uint8_t x, uint8_t y,
+    uint8_t width);
+
+/* An LCD driven through its RS, R/W, E, and DB lines.  Bus cycles go to a
+ * PololuHD44780Model, and the LCD stays busy after each instruction for the
+ * time the model says it takes, measured with the virtual clock.  Starting a
+ * bus cycle while the LCD is busy counts as a timing violation. */
+class HostLcd
+{
+public:
+    HostLcd()
+    {
+        reset();
+    }
+
+    /* Puts the LCD in its power-on state and clears the counts. */
+    void reset();
+
+    /* Sets the levels of the lines, as seen by the LCD.  A falling edge on E
+     * with R/W low is a write; a rising edge on E with R/W high starts a
+     * read.  In 4-bit mode, only DB7 through DB4 (the upper bits of data)
+     * are used. */
+    void setLines(bool rs, bool rw, bool e, uint8_t data);
+
+    /* Returns the levels the LCD drives on DB7 through DB0 during a read. */
+    uint8_t dataOutput() const
+    {
+        return output;
+    }
+
+    /* Returns true if the LCD is still executing an instruction. */
+    bool busy() const
+    {
+        return (int32_t)(hostTime() - busyUntil) < 0;
+    }
+
+    /* Returns what the specified row of the screen shows, using the 20x4
+     * layout of PololuHD44780Model::characterAt(). */
+    std::string row(uint8_t y, uint8_t width = 20) const
+    {
+        return screenText(model, 0, y, width);
+    }
+
+    PololuHD44780Model model;
+
+    /* The number of bus cycles that started while the LCD was busy. */
+    uint16_t timingViolations;
+
+    /* Makes the LCD slower than the model: every instruction keeps it busy
+     * for at least this many microseconds.  Zero after reset(). */
+    uint16_t minimumBusyTime;
+
+private:
+    uint32_t busyUntil;
+    bool lastE;
+
+    /* In 4-bit mode, true if the next read returns the lower nibble. */
+    bool readLowNibble;
+    uint8_t readValue;
+    uint8_t output;
+};
+
+/* Connects a HostLcd to Arduino pins, so that the pin-based classes in
+ * PololuHD44780.h can drive it with digitalWrite() and read it with
+ * digitalRead().  Pass 255 for any line that is not connected.  The wiring
+ * installs itself as the pin handler when it is created. */
+class HostLcdPins : public HostPinHandler
+{
+public:
+    /* Creates a 4-bit wiring. */
+    HostLcdPins(HostLcd & lcd, uint8_t rs, uint8_t rw, uint8_t e,
+        uint8_t db4, uint8_t db5, uint8_t db6, uint8_t db7);
+
+    /* Creates an 8-bit wiring. */
+    HostLcdPins(HostLcd & lcd, uint8_t rs, uint8_t e, const uint8_t db[8]);
+
+    ~HostLcdPins();
+
+    virtual void digitalWrite(uint8_t pin, uint8_t value);
+    virtual int digitalRead(uint8_t pin);
+
+private:
+    void update();
+
+    HostLcd * lcd;
+    uint8_t rs, rw, e;
+
+    /* The pin connected to each of DB0 through DB7. */
+    uint8_t db[8];
+
+    uint8_t levels[256];
+};
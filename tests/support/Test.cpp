@@ -0,0 +1,42 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+#include "Test.h"
+#include <stdio.h>
+
+static unsigned checks;
+static unsigned failures;
+
+void testCheck(bool condition, const char * text, const char * file,
+    int line)
+{
+    checks++;
+    if (condition) { return; }
+    failures++;
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, text);
+}
+
+void testCheckEqual(long expected, long actual, const char * expectedText,
+    const char * actualText, const char * file, int line)
+{
+    checks++;
+    if (expected == actual) { return; }
+    failures++;
+    fprintf(stderr, "%s:%d: expected %s == %s, but %ld != %ld\n",
+        file, line, expectedText, actualText, expected, actual);
+}
+
+void testCheckString(const std::string & expected, const std::string & actual,
+    const char * actualText, const char * file, int line)
+{
+    checks++;
+    if (expected == actual) { return; }
+    failures++;
+    fprintf(stderr, "%s:%d: %s is \"%s\", expected \"%s\"\n",
+        file, line, actualText, actual.c_str(), expected.c_str());
+}
+
+int testResult()
+{
+    printf("%u checks, %u failures\n", checks, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,29 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+/* A tiny test framework: each test program calls CHECK() as many times as it
+ * likes and returns testResult() from main(). */
+
+#pragma once
+#include <string>
+
+#define CHECK(condition) \
+    testCheck((condition), #condition, __FILE__, __LINE__)
+
+#define CHECK_EQUAL(expected, actual) \
+    testCheckEqual((long)(expected), (long)(actual), \
+        #expected, #actual, __FILE__, __LINE__)
+
+#define CHECK_STRING(expected, actual) \
+    testCheckString((expected), (actual), #actual, __FILE__, __LINE__)
+
+void testCheck(bool condition, const char * text, const char * file,
+    int line);
+
+void testCheckEqual(long expected, long actual, const char * expectedText,
+    const char * actualText, const char * file, int line);
+
+void testCheckString(const std::string & expected, const std::string & actual,
+    const char * actualText, const char * file, int line);
+
+/* Prints a summary and returns the exit code for main(). */
+int testResult();
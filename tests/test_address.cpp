@@ -0,0 +1,134 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+// Tests that the library keeps track of the LCD's address counter, so it can
+// skip "Set DDRAM address" commands and upload custom characters with a
+// single address command.
+
+#include <PololuHD44780Model.h>
+#include <HostLcd.h>
+#include <Test.h>
+
+static void testGotoXYSkipsCommands()
+{
+    PololuHD44780Emulator lcd(true);
+    lcd.init();
+    lcd.model.resetCounters();
+
+    lcd.gotoXY(0, 0);
+    CHECK_EQUAL(0, lcd.model.commandCount());
+
+    lcd.print("ab");
+    lcd.gotoXY(2, 0);
+    CHECK_EQUAL(0, lcd.model.commandCount());
+
+    lcd.gotoXY(5, 1);
+    CHECK_EQUAL(1, lcd.model.commandCount());
+
+    // Right to left, the counter moves the other way.
+    lcd.rightToLeft();
+    lcd.print("xy");
+    lcd.gotoXY(3, 1);
+    CHECK_EQUAL(2, lcd.model.commandCount());
+
+    // The counter goes from the end of the first line to the second line.
+    lcd.leftToRight();
+    lcd.gotoXY(39, 0);
+    lcd.print("AB");
+    lcd.model.resetCounters();
+    lcd.gotoXY(1, 1);
+    CHECK_EQUAL(0, lcd.model.commandCount());
+    CHECK_EQUAL('B', lcd.model.ddramByte(0x40));
+}
+
+static void testUnknownAddress()
+{
+    PololuHD44780Emulator lcd(true);
+
+    // After a raw "Set CGRAM address" command, the next gotoXY() must send a
+    // command even if it goes back to the same place.
+    lcd.gotoXY(0, 1);
+    lcd.command(0x40);
+    lcd.model.resetCounters();
+    lcd.gotoXY(0, 1);
+    lcd.print("p");
+    CHECK_EQUAL(1, lcd.model.commandCount());
+    CHECK_STRING("p", screenText(lcd.model, 0, 1, 1));
+}
+
+static void testRawCommands()
+{
+    PololuHD44780Emulator lcd(true);
+
+    // An entry mode sent with command() changes the direction the address
+    // counter moves.
+    lcd.clear();
+    lcd.command(0x04);
+    lcd.write('a');
+    lcd.gotoXY(1, 0);
+    lcd.write('b');
+    CHECK_EQUAL('a', lcd.model.ddramByte(0x00));
+    CHECK_EQUAL('b', lcd.model.ddramByte(0x01));
+
+    // The display control sent with command() is remembered too, so
+    // display() is not skipped as unchanged.
+    lcd.command(0x08);
+    lcd.beginUpdate();
+    lcd.display();
+    lcd.endUpdate();
+    CHECK_EQUAL(0b100, lcd.model.displayControl());
+
+    // And so is leftToRight() after that entry mode.
+    lcd.beginUpdate();
+    lcd.leftToRight();
+    lcd.endUpdate();
+    CHECK_EQUAL(0b10, lcd.model.entryMode());
+}
+
+static void testCustomCharacters()
+{
+    static const uint8_t table[64] PROGMEM = {
+        1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16,
+        17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32,
+        33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48,
+        49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64,
+    };
+
+    PololuHD44780Emulator lcd(true);
+    lcd.gotoXY(3, 1);
+    lcd.print("a");
+
+    // One address command for all 8 characters and one to go back.
+    lcd.model.resetCounters();
+    lcd.loadCustomCharacters(table);
+    CHECK_EQUAL(2, lcd.model.commandCount());
+    CHECK_EQUAL(64, lcd.model.dataCount());
+    for (uint8_t i = 0; i < 64; i++)
+    {
+        CHECK_EQUAL(i + 1, lcd.model.cgramByte(i));
+    }
+
+    // The cursor is back where it was.
+    lcd.print("b");
+    CHECK_EQUAL('b', lcd.model.ddramByte(0x44));
+
+    // Custom characters are uploaded the right way around even when the
+    // LCD is in right-to-left mode.
+    const uint8_t picture[8] = { 90, 91, 92, 93, 94, 95, 96, 97 };
+    lcd.rightToLeft();
+    lcd.loadCustomCharacterFromRam(picture, 3);
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        CHECK_EQUAL(90 + i, lcd.model.cgramByte(24 + i));
+    }
+    lcd.print("c");
+    CHECK_EQUAL('c', lcd.model.ddramByte(0x45));
+}
+
+int main()
+{
+    testGotoXYSkipsCommands();
+    testUnknownAddress();
+    testRawCommands();
+    testCustomCharacters();
+    return testResult();
+}
@@ -0,0 +1,86 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+// Tests asynchronous mode.
+
+#include <PololuHD44780Model.h>
+#include <HostLcd.h>
+#include <Test.h>
+
+static void testQueue()
+{
+    HostLcd sim;
+    HostLcdPins pins(sim, 7, 255, 6, 5, 4, 3, 2);
+    PololuHD44780 lcd(7, 6, 5, 4, 3, 2);
+    PololuHD44780QueueBuffer<8> queue;
+
+    lcd.init();
+    lcd.enableAsync(queue);
+
+    // Adding transfers to the queue does not wait for the LCD.
+    uint32_t start = hostTime();
+    lcd.clear();
+    lcd.print("hello");
+    CHECK(hostTime() - start < 100);
+    CHECK_EQUAL(6, queue.length());
+    CHECK_STRING("     ", sim.row(0, 5));
+
+    while (!lcd.poll()) { hostAdvance(10); }
+    CHECK_STRING("hello", sim.row(0, 5));
+
+    // When the queue is full, the caller polls until there is room.
+    lcd.print("0123456789abc");
+    CHECK(queue.overflowCount() > 0);
+    lcd.drainQueue();
+    CHECK_STRING("hello0123456789abc  ", sim.row(0));
+
+    lcd.disableAsync();
+    lcd.print("!");
+    CHECK_STRING("hello0123456789abc! ", sim.row(0));
+    CHECK_EQUAL(0, sim.timingViolations);
+}
+
+static void testLongIdle()
+{
+    HostLcd sim;
+    HostLcdPins pins(sim, 7, 255, 6, 5, 4, 3, 2);
+    PololuHD44780 lcd(7, 6, 5, 4, 3, 2);
+    PololuHD44780QueueBuffer<8> queue;
+
+    lcd.init();
+    lcd.enableAsync(queue);
+    lcd.clear();
+    CHECK(lcd.poll());
+
+    // Long after the clear finished, when the low 16 bits of micros() are
+    // back to where they were when it was sent, the next transfer still
+    // goes out right away.
+    hostAdvance(65536 + 100);
+    lcd.print("x");
+    CHECK(lcd.poll());
+    CHECK_STRING("x", sim.row(0, 1));
+    CHECK_EQUAL(0, sim.timingViolations);
+}
+
+static void testLargestQueue()
+{
+    PololuHD44780Emulator lcd;
+    PololuHD44780QueueBuffer<254> queue;
+    CHECK_EQUAL(254, queue.capacity());
+
+    lcd.init();
+    lcd.enableAsync(queue);
+    lcd.model.resetCounters();
+    for (uint8_t i = 0; i < 254; i++) { lcd.write('a' + i % 26); }
+    CHECK_EQUAL(254, queue.length());
+    CHECK_EQUAL(0, queue.overflowCount());
+    lcd.drainQueue();
+    CHECK_EQUAL(254, lcd.model.dataCount());
+}
+
+int main()
+{
+    testQueue();
+    testLongIdle();
+    testLargestQueue();
+    return testResult();
+}
@@ -0,0 +1,156 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+// Tests beginUpdate() and endUpdate().
+
+#include <PololuHD44780Model.h>
+#include <HostLcd.h>
+#include <Test.h>
+#include <stdlib.h>
+
+// Performs one of a set of operations, chosen by k and parameterized by a
+// and b.
+static void operation(PololuHD44780Emulator & lcd, int k, int a, int b)
+{
+    static const uint8_t text[] = "ab#yz";
+    switch (k)
+    {
+    case 0: lcd.write(text + a % 3, 1 + b % 3); break;
+    case 1: lcd.gotoXY(a % 20, b % 2); break;
+    case 2: if (a % 2) { lcd.rightToLeft(); } else { lcd.leftToRight(); } break;
+    case 3: if (a % 4) { lcd.noAutoscroll(); } else { lcd.autoscroll(); } break;
+    case 4: if (a % 2) { lcd.noDisplay(); } else { lcd.display(); } break;
+    case 5:
+        switch (a % 4)
+        {
+        case 0: lcd.cursorSolid(); break;
+        case 1: lcd.cursorBlinking(); break;
+        case 2: lcd.hideCursor(); break;
+        default: lcd.blink(); break;
+        }
+        break;
+    case 6: if (a % 3 == 0) { lcd.clear(); } break;
+    case 7:
+    {
+        const uint8_t picture[8] = { 1, 2, 3, 4, 5, 6, 7, (uint8_t)a };
+        lcd.loadCustomCharacterFromRam(picture, b % 8);
+        break;
+    }
+    case 8: if (a % 3 == 0) { lcd.fastClear(); } break;
+    default: if (a % 2) { lcd.scrollDisplayLeft(); } else { lcd.home(); } break;
+    }
+}
+
+static bool sameState(PololuHD44780Emulator & x, PololuHD44780Emulator & y)
+{
+    for (uint8_t a = 0; a < 40; a++)
+    {
+        if (x.model.ddramByte(a) != y.model.ddramByte(a)) { return false; }
+        if (x.model.ddramByte(0x40 + a) != y.model.ddramByte(0x40 + a))
+        {
+            return false;
+        }
+    }
+    for (uint8_t a = 0; a < 64; a++)
+    {
+        if (x.model.cgramByte(a) != y.model.cgramByte(a)) { return false; }
+    }
+    return x.model.entryMode() == y.model.entryMode() &&
+        x.model.displayControl() == y.model.displayControl() &&
+        x.model.displayShift() == y.model.displayShift();
+}
+
+// Runs random operations on two LCDs, one of them with random (nested)
+// batches, and checks that they end up the same.
+static void testRandomBatches()
+{
+    srand(3);
+    for (int trial = 0; trial < 2000; trial++)
+    {
+        PololuHD44780Emulator plain(trial % 2), batched(trial % 2);
+        plain.init();
+        batched.init();
+        plain.model.resetCounters();
+        batched.model.resetCounters();
+
+        int depth = 0;
+        int count = rand() % 30;
+        for (int i = 0; i < count; i++)
+        {
+            int r = rand() % 10;
+            if (r == 0)
+            {
+                batched.beginUpdate();
+                depth++;
+            }
+            else if (r == 1 && depth)
+            {
+                batched.endUpdate();
+                depth--;
+                if (depth == 0) { CHECK(sameState(plain, batched)); }
+            }
+            else
+            {
+                int k = rand() % 10, a = rand(), b = rand();
+                operation(plain, k, a, b);
+                operation(batched, k, a, b);
+            }
+        }
+        while (depth--) { batched.endUpdate(); }
+        CHECK(sameState(plain, batched));
+        CHECK(batched.model.commandCount() <= plain.model.commandCount());
+    }
+}
+
+static void testCoalescing()
+{
+    PololuHD44780Emulator lcd;
+    lcd.init();
+    lcd.print("hi");
+
+    // Only the clear command is needed.
+    lcd.model.resetCounters();
+    lcd.beginUpdate();
+    lcd.noDisplay();
+    lcd.clear();
+    lcd.cursorSolid();
+    lcd.noCursor();
+    lcd.leftToRight();
+    lcd.display();
+    lcd.print("ok");
+    lcd.endUpdate();
+    CHECK_EQUAL(1, lcd.model.commandCount());
+    CHECK_STRING("ok", screenText(lcd.model, 0, 0, 2));
+
+    // Only the outermost endUpdate() sends anything.
+    lcd.model.resetCounters();
+    lcd.beginUpdate();
+    lcd.beginUpdate();
+    lcd.rightToLeft();
+    lcd.cursorSolid();
+    lcd.endUpdate();
+    CHECK_EQUAL(0, lcd.model.commandCount());
+    lcd.leftToRight();
+    lcd.endUpdate();
+    CHECK_EQUAL(1, lcd.model.commandCount());
+    CHECK_EQUAL(0b110, lcd.model.displayControl());
+}
+
+static void testFramebufferFlush()
+{
+    PololuHD44780Emulator lcd;
+    PololuHD44780Framebuffer framebuffer;
+    lcd.enableFramebuffer(framebuffer);
+
+    lcd.beginUpdate();
+    lcd.print("hello");
+    lcd.endUpdate();
+    CHECK_STRING("hello", screenText(lcd.model, 0, 0, 5));
+}
+
+int main()
+{
+    testRandomBatches();
+    testCoalescing();
+    testFramebufferFlush();
+    return testResult();
+}
@@ -0,0 +1,144 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+// Tests fields and the marquee.
+
+#include <PololuHD44780Model.h>
+#include <PololuHD44780Marquee.h>
+#include <HostLcd.h>
+#include <Test.h>
+
+static void testNumbers()
+{
+    PololuHD44780Emulator lcd(true);
+    PololuHD44780FieldBuffer<6> field(10, 1, PololuHD44780Field::alignRight);
+    lcd.addField(field);
+    lcd.clear();
+
+    lcd.model.resetCounters();
+    lcd.printField(field, 1234, 2);
+    CHECK_STRING(" 12.34", screenText(lcd.model, 10, 1, 6));
+    CHECK_EQUAL(5, lcd.model.dataCount());
+
+    // Only the digit that changed is sent.
+    lcd.model.resetCounters();
+    lcd.printField(field, 1235, 2);
+    CHECK_STRING(" 12.35", screenText(lcd.model, 10, 1, 6));
+    CHECK_EQUAL(1, lcd.model.commandCount());
+    CHECK_EQUAL(1, lcd.model.dataCount());
+
+    lcd.model.resetCounters();
+    lcd.printField(field, 1235, 2);
+    CHECK_EQUAL(0, lcd.model.busCycleCount());
+
+    lcd.printField(field, -5, 2);
+    CHECK_STRING(" -0.05", screenText(lcd.model, 10, 1, 6));
+    lcd.printField(field, 1234567);
+    CHECK_STRING("******", screenText(lcd.model, 10, 1, 6));
+    lcd.printField(field, -2147483647L - 1);
+    CHECK_STRING("******", screenText(lcd.model, 10, 1, 6));
+    lcd.printField(field, 0);
+    CHECK_STRING("     0", screenText(lcd.model, 10, 1, 6));
+
+    // Clearing the screen keeps added fields in sync.
+    lcd.clear();
+    lcd.model.resetCounters();
+    lcd.printField(field, 5);
+    CHECK_EQUAL(1, lcd.model.dataCount());
+    CHECK_STRING("     5", screenText(lcd.model, 10, 1, 6));
+}
+
+static void testText()
+{
+    PololuHD44780Emulator lcd(true);
+    PololuHD44780FieldBuffer<5> field(0, 0);
+
+    lcd.printField(field, "hello world");
+    CHECK_STRING("hello", screenText(lcd.model, 0, 0, 5));
+    lcd.printField(field, F("hi"));
+    CHECK_STRING("hi   ", screenText(lcd.model, 0, 0, 5));
+
+    // Fields are written left to right, whatever the entry mode.
+    lcd.rightToLeft();
+    lcd.printField(field, "ab");
+    CHECK_STRING("ab   ", screenText(lcd.model, 0, 0, 5));
+    CHECK_EQUAL(0b00, lcd.model.entryMode());
+
+    // After invalidate(), the whole field is sent again.
+    lcd.model.resetCounters();
+    field.invalidate();
+    lcd.printField(field, "ab");
+    CHECK_EQUAL(5, lcd.model.dataCount());
+}
+
+static std::string scrolled(const char * text, int offset, int width)
+{
+    std::string s;
+    int length = strlen(text);
+    for (int i = 0; i < width; i++)
+    {
+        s += text[((offset + i) % length + length) % length];
+    }
+    return s;
+}
+
+static void testMarquee(uint8_t width, bool geometry)
+{
+    const char * news = "Breaking news: the LCD scrolls without rewriting. ";
+    PololuHD44780Emulator lcd(true);
+    if (geometry) { lcd.setGeometry(PololuHD44780Geometry(width, 2)); }
+    lcd.print("junk");
+    lcd.scrollDisplayLeft();
+
+    PololuHD44780Marquee marquee(lcd, width);
+    marquee.setScrolling(0, news);
+    marquee.setStatic(1, "Temp: 21C");
+    marquee.begin();
+
+    std::string fixed("Temp: 21C");
+    fixed.resize(width, ' ');
+
+    int offset = 0;
+    for (int step = 0; step < 120; step++)
+    {
+        CHECK_STRING(scrolled(news, offset, width),
+            screenText(lcd.model, 0, 0, width));
+        CHECK_STRING(fixed.substr(0, width),
+            screenText(lcd.model, 0, 1, width));
+        if (step < 60)
+        {
+            marquee.scrollLeft();
+            offset++;
+        }
+        else
+        {
+            marquee.scrollRight();
+            offset--;
+        }
+    }
+}
+
+static void testMarqueeCost()
+{
+    PololuHD44780Emulator lcd(true);
+    PololuHD44780Marquee marquee(lcd, 16);
+    marquee.setScrolling(0, F("0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJ"));
+    marquee.begin();
+
+    // One shift command, one address command, and the new character.
+    lcd.model.resetCounters();
+    marquee.scrollLeft();
+    CHECK_EQUAL(2, lcd.model.commandCount());
+    CHECK_EQUAL(1, lcd.model.dataCount());
+}
+
+int main()
+{
+    testNumbers();
+    testText();
+    testMarquee(16, false);
+    testMarquee(16, true);
+    testMarquee(20, false);
+    testMarquee(8, true);
+    testMarqueeCost();
+    return testResult();
+}
@@ -0,0 +1,114 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+// Tests framebuffer mode.
+
+#include <PololuHD44780.h>
+#include <HostLcd.h>
+#include <Test.h>
+
+static void testFlushSendsChanges()
+{
+    HostLcd sim;
+    HostLcdPins pins(sim, 7, 255, 6, 5, 4, 3, 2);
+    PololuHD44780 lcd(7, 6, 5, 4, 3, 2);
+    PololuHD44780Framebuffer framebuffer;
+
+    lcd.enableFramebuffer(framebuffer);
+    lcd.print("Temp: 21.5 C");
+    lcd.gotoXY(0, 1);
+    lcd.print("Hum:  40 %");
+    lcd.gotoXY(0, 3);
+    lcd.print("row3");
+
+    // Nothing is sent until the flush.
+    CHECK_STRING("                    ", sim.row(0));
+    lcd.flush();
+    CHECK_STRING("Temp: 21.5 C        ", sim.row(0));
+    CHECK_STRING("Hum:  40 %          ", sim.row(1));
+    CHECK_STRING("row3                ", sim.row(3));
+
+    // Redrawing the whole screen only sends the characters that changed,
+    // with one address command for each run.
+    lcd.clear();
+    lcd.print("Temp: 21.7 C");
+    lcd.gotoXY(0, 1);
+    lcd.print("Hum:  41 %");
+    lcd.gotoXY(0, 3);
+    lcd.print("row3");
+    sim.model.resetCounters();
+    lcd.flush();
+    CHECK_STRING("Temp: 21.7 C        ", sim.row(0));
+    CHECK_STRING("Hum:  41 %          ", sim.row(1));
+    CHECK_EQUAL(2, sim.model.commandCount());
+    CHECK_EQUAL(2, sim.model.dataCount());
+
+    // A flush with no changes sends nothing.
+    sim.model.resetCounters();
+    lcd.flush();
+    CHECK_EQUAL(0, sim.model.busCycleCount());
+    CHECK_EQUAL(0, sim.timingViolations);
+}
+
+static void testEntryModes()
+{
+    HostLcd sim;
+    HostLcdPins pins(sim, 7, 255, 6, 5, 4, 3, 2);
+    PololuHD44780 lcd(7, 6, 5, 4, 3, 2);
+    PololuHD44780Framebuffer framebuffer;
+
+    lcd.enableFramebuffer(framebuffer);
+    lcd.rightToLeft();
+    lcd.gotoXY(5, 2);
+    lcd.print("ab");
+    lcd.flush();
+    CHECK_STRING("    ba    ", sim.row(2, 10));
+
+    // The flush writes from left to right but puts the entry mode back.
+    CHECK_EQUAL(0b00, sim.model.entryMode());
+}
+
+static void testDisable()
+{
+    HostLcd sim;
+    HostLcdPins pins(sim, 7, 255, 6, 5, 4, 3, 2);
+    PololuHD44780 lcd(7, 6, 5, 4, 3, 2);
+    PololuHD44780Framebuffer framebuffer;
+
+    lcd.enableFramebuffer(framebuffer);
+    lcd.print("hello");
+    lcd.gotoXY(0, 0);
+    lcd.disableFramebuffer();
+    lcd.print("J");
+    CHECK_STRING("Jello     ", sim.row(0, 10));
+    CHECK_EQUAL(0, sim.timingViolations);
+}
+
+static void testReinitialize()
+{
+    HostLcd sim;
+    HostLcdPins pins(sim, 7, 255, 6, 5, 4, 3, 2);
+    PololuHD44780 lcd(7, 6, 5, 4, 3, 2);
+    PololuHD44780Framebuffer framebuffer;
+
+    lcd.enableFramebuffer(framebuffer);
+    lcd.print("hello");
+    lcd.flush();
+
+    // Initializing the LCD clears it, so the same text has to be sent again.
+    lcd.reinitialize();
+    CHECK_STRING("     ", sim.row(0, 5));
+    lcd.clear();
+    lcd.print("hello");
+    lcd.flush();
+    CHECK_STRING("hello", sim.row(0, 5));
+    CHECK_EQUAL(0, sim.timingViolations);
+}
+
+int main()
+{
+    testFlushSendsChanges();
+    testEntryModes();
+    testDisable();
+    testReinitialize();
+    return testResult();
+}
@@ -0,0 +1,213 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+// Tests display geometries, line wrapping, fastClear(), and fastHome().
+
+#include <PololuHD44780Model.h>
+#include <HostLcd.h>
+#include <Test.h>
+
+struct Layout
+{
+    uint8_t columns, rows;
+    bool split;
+};
+
+static const Layout layouts[] = {
+    { 8, 1, false }, { 16, 1, true }, { 16, 2, false }, { 16, 4, false },
+    { 20, 2, false }, { 20, 4, false }, { 40, 2, false },
+};
+
+// Returns the whole screen in reading order, according to the geometry.
+static std::string screen(PololuHD44780Emulator & lcd,
+    const PololuHD44780Geometry & geometry)
+{
+    std::string s;
+    for (uint8_t y = 0; y < geometry.rows; y++)
+    {
+        for (uint8_t x = 0; x < geometry.columns; x++)
+        {
+            s += (char)lcd.model.ddramByte(geometry.address(x, y));
+        }
+    }
+    return s;
+}
+
+// Prints more characters than fit on the screen, starting at every third
+// position, and checks that they wrap from row to row and back to the top.
+static void testWrapping(const Layout & layout, bool reverse)
+{
+    PololuHD44780Geometry geometry(layout.columns, layout.rows, layout.split);
+    const int size = layout.columns * layout.rows;
+    std::string text;
+    for (int i = 0; i < size + 5; i++) { text += (char)('!' + i % 90); }
+
+    for (int start = 0; start < size; start += 3)
+    {
+        PololuHD44780Emulator lcd(true);
+        lcd.setGeometry(geometry);
+        lcd.clear();
+        lcd.gotoXY(start % layout.columns, start / layout.columns);
+        if (reverse) { lcd.rightToLeft(); }
+        lcd.model.resetCounters();
+        lcd.print(text.c_str());
+
+        std::string expected(size, ' ');
+        for (int i = 0; i < (int)text.size(); i++)
+        {
+            int position = reverse ? start - i : start + i;
+            expected[(position % size + size) % size] = text[i];
+        }
+        CHECK_STRING(expected, screen(lcd, geometry));
+
+        // One address command per row (or half row) at most.
+        if (!reverse)
+        {
+            CHECK(lcd.model.commandCount() <=
+                layout.rows * (layout.split ? 2 : 1) + 1);
+        }
+
+        // Writing one character at a time or through the framebuffer gives
+        // the same result.
+        PololuHD44780Emulator single(true);
+        single.setGeometry(geometry);
+        single.clear();
+        single.gotoXY(start % layout.columns, start / layout.columns);
+        if (reverse) { single.rightToLeft(); }
+        for (size_t i = 0; i < text.size(); i++) { single.write(text[i]); }
+        CHECK_STRING(expected, screen(single, geometry));
+
+        if (reverse) { continue; }
+        PololuHD44780Emulator buffered(true);
+        PololuHD44780Framebuffer framebuffer;
+        buffered.setGeometry(geometry);
+        buffered.enableFramebuffer(framebuffer);
+        buffered.gotoXY(start % layout.columns, start / layout.columns);
+        buffered.print(text.c_str());
+        buffered.flush();
+        CHECK_STRING(expected, screen(buffered, geometry));
+    }
+}
+
+static void testNoWrapBeforeGotoXY()
+{
+    // Filling a row exactly and then moving the cursor must not wrap.
+    PololuHD44780Emulator lcd(true);
+    lcd.setGeometry(PololuHD44780Geometry(20, 4));
+    lcd.print("01234567890123456789");
+    lcd.gotoXY(0, 2);
+    lcd.print("X");
+    CHECK_EQUAL('X', lcd.model.ddramByte(0x14));
+    CHECK_EQUAL(' ', lcd.model.ddramByte(0x40));
+}
+
+static void testWrapAfterCommands()
+{
+    // Commands that do not move the address counter keep a pending wrap.
+    PololuHD44780Emulator lcd(true);
+    lcd.setGeometry(PololuHD44780Geometry(16, 2));
+    lcd.clear();
+    lcd.print("0123456789abcdef");
+    lcd.cursorBlinking();
+    lcd.print("XY");
+    CHECK_STRING("XY", screenText(lcd.model, 0, 1, 2));
+    CHECK_EQUAL(' ', lcd.model.ddramByte(0x10));
+
+    // So do deferred commands and custom character uploads.
+    const uint8_t picture[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    lcd.gotoXY(0, 0);
+    lcd.print("0123456789abcdef");
+    lcd.beginUpdate();
+    lcd.noCursor();
+    lcd.rightToLeft();
+    lcd.leftToRight();
+    lcd.endUpdate();
+    lcd.loadCustomCharacterFromRam(picture, 2);
+    lcd.print("Z");
+    CHECK_STRING("Z", screenText(lcd.model, 0, 1, 1));
+    CHECK_EQUAL(' ', lcd.model.ddramByte(0x10));
+
+    // Commands that move it cancel the wrap.
+    lcd.gotoXY(0, 0);
+    lcd.print("0123456789abcdef");
+    lcd.home();
+    lcd.print("h");
+    CHECK_EQUAL('h', lcd.model.ddramByte(0x00));
+}
+
+static void testGeometryLimits()
+{
+    // Row counts outside 1 to 4 must not reach past the row addresses.
+    PololuHD44780Geometry none(16, 0);
+    CHECK_EQUAL(1, none.rows);
+    PololuHD44780Geometry many(20, 7);
+    CHECK_EQUAL(4, many.rows);
+    CHECK_EQUAL(40, PololuHD44780Geometry(200, 2).columns);
+    CHECK_EQUAL(80, PololuHD44780Geometry(200, 1, true).columns);
+
+    PololuHD44780Emulator lcd(true);
+    lcd.setGeometry(many);
+    lcd.gotoXY(1, 6);
+    lcd.print("a");
+    CHECK_STRING("a", screenText(lcd.model, 1, 3, 1));
+
+    lcd.setGeometry(none);
+    lcd.gotoXY(2, 3);
+    lcd.print("b");
+    CHECK_EQUAL('b', lcd.model.ddramByte(0x02));
+}
+
+static void testDefaultGeometry()
+{
+    // Without a geometry, text runs on through DDRAM like it always has.
+    PololuHD44780Emulator lcd(true);
+    lcd.print("0123456789012345678901");
+    CHECK_EQUAL('1', lcd.model.ddramByte(0x15));
+}
+
+static void testFastClear()
+{
+    PololuHD44780Emulator lcd;
+    lcd.print("0123456789abcdef");
+    lcd.gotoXY(0, 1);
+    lcd.print("0123456789abcdef");
+    lcd.scrollDisplayLeft();
+    lcd.autoscroll();
+
+    uint16_t time = lcd.fastClear();
+    CHECK(time < 2000);
+    CHECK_STRING("                    ", screenText(lcd.model, 0, 0, 20));
+    CHECK_STRING("                    ", screenText(lcd.model, 0, 1, 20));
+    CHECK_EQUAL(0, lcd.model.displayShift());
+    CHECK_EQUAL(0, lcd.model.addressCounter());
+
+    // Like the clear command, fastClear() sets I/D but keeps auto-scrolling.
+    CHECK_EQUAL(0b11, lcd.model.entryMode());
+}
+
+static void testFastHome()
+{
+    PololuHD44780Emulator lcd;
+    lcd.print("hello");
+    for (uint8_t i = 0; i < 10; i++) { lcd.scrollDisplayLeft(); }
+    uint16_t time = lcd.fastHome();
+    CHECK(time < 1600);
+    CHECK_EQUAL(0, lcd.model.displayShift());
+    CHECK_EQUAL(0, lcd.model.addressCounter());
+    CHECK_STRING("hello", screenText(lcd.model, 0, 0, 5));
+}
+
+int main()
+{
+    for (size_t i = 0; i < sizeof(layouts) / sizeof(layouts[0]); i++)
+    {
+        testWrapping(layouts[i], false);
+        testWrapping(layouts[i], true);
+    }
+    testNoWrapBeforeGotoXY();
+    testWrapAfterCommands();
+    testGeometryLimits();
+    testDefaultGeometry();
+    testFastClear();
+    testFastHome();
+    return testResult();
+}
@@ -0,0 +1,136 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+// Tests PololuHD44780I2C against a simulated PCF8574 backpack on a simulated
+// I2C bus.
+
+#include <PololuHD44780I2C.h>
+#include <HostLcd.h>
+#include <Test.h>
+
+// A PCF8574 wired to the LCD the way PololuHD44780I2C expects: P0 to RS, P1
+// to R/W, P2 to E, and P4 through P7 to DB4 through DB7.
+class Backpack : public HostWireHandler
+{
+public:
+    Backpack(HostLcd & lcd) : lcd(lcd)
+    {
+        hostSetWireHandler(this);
+    }
+
+    ~Backpack()
+    {
+        hostSetWireHandler(NULL);
+    }
+
+    virtual void receive(uint8_t address, uint8_t value)
+    {
+        if (address != 0x27) { return; }
+        lcd.setLines(value & 1, value & 2, value & 4, value & 0xF0);
+    }
+
+private:
+    HostLcd & lcd;
+};
+
+static void testSendTime()
+{
+    CHECK_EQUAL(90, PololuHD44780I2C(0x27, Wire).sendTime());
+    CHECK_EQUAL(360, PololuHD44780I2C(0x27, Wire, 100000).sendTime());
+
+    PololuHD44780I2C lcd;
+    lcd.setBusClock(1000000);
+    CHECK_EQUAL(36, lcd.sendTime());
+}
+
+static void testPrint()
+{
+    HostLcd sim;
+    Backpack backpack(sim);
+    Wire.setClock(400000);
+    PololuHD44780I2C lcd;
+
+    lcd.clear();
+    lcd.print("hello");
+    lcd.gotoXY(3, 1);
+    lcd.print("world, this is long");
+    CHECK_STRING("hello               ", sim.row(0));
+    CHECK_STRING("   world, this is lo", sim.row(1));
+    CHECK_EQUAL(0, sim.timingViolations);
+}
+
+static void testSlowBus()
+{
+    HostLcd sim;
+    Backpack backpack(sim);
+    Wire.setClock(100000);
+    PololuHD44780I2C lcd(0x27, Wire, 100000);
+    lcd.clear();
+
+    // The 360 us before E falls in the next transaction count towards the
+    // clear's execution time, so the library only delays for the rest.  With
+    // 540 us for each transaction, that is 540 + (2000 - 360) + 540 us, where
+    // assuming 400 kHz would take 540 + (2000 - 90) + 540 us.
+    uint32_t start = hostTime();
+    lcd.clear();
+    lcd.print("x");
+    uint32_t time = hostTime() - start;
+    CHECK(time < 2800);
+    CHECK_STRING("x ", sim.row(0, 2));
+    CHECK_EQUAL(0, sim.timingViolations);
+}
+
+static void testWrongBusClock()
+{
+    // Claiming a slower bus than the real one makes the delays too short.
+    HostLcd sim;
+    Backpack backpack(sim);
+    Wire.setClock(400000);
+    PololuHD44780I2C lcd(0x27, Wire, 100000);
+    lcd.setTiming(PololuHD44780Timing::st7066u());
+    lcd.clear();
+    lcd.print("x");
+    CHECK(sim.timingViolations > 0);
+}
+
+static void testFastBus()
+{
+    // At 1 MHz, two I2C bytes take less time than the LCD needs for a
+    // character, so strings are sent one byte per transmission.
+    HostLcd sim;
+    Backpack backpack(sim);
+    Wire.setClock(1000000);
+    PololuHD44780I2C lcd(0x27, Wire, 1000000);
+    lcd.clear();
+    lcd.print("hello world");
+    CHECK_STRING("hello world ", sim.row(0, 12));
+    CHECK_EQUAL(0, sim.timingViolations);
+}
+
+static void testSlowTiming()
+{
+    // A timing profile with a longer data time than the gap between bytes
+    // in a transmission is respected too.
+    HostLcd sim;
+    Backpack backpack(sim);
+    Wire.setClock(400000);
+    PololuHD44780I2C lcd;
+    lcd.setTiming(PololuHD44780Timing(37, 80, 2000, 1600));
+    lcd.clear();
+
+    // Make the simulated LCD as slow as the profile says.
+    sim.minimumBusyTime = 80;
+    lcd.print("hello world");
+    CHECK_STRING("hello world ", sim.row(0, 12));
+    CHECK_EQUAL(0, sim.timingViolations);
+}
+
+int main()
+{
+    testSendTime();
+    testPrint();
+    testSlowBus();
+    testWrongBusClock();
+    testFastBus();
+    testSlowTiming();
+    return testResult();
+}
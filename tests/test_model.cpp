@@ -0,0 +1,149 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+// Tests PololuHD44780Model by feeding it bus cycles directly.
+
+#include <PololuHD44780Model.h>
+#include <HostLcd.h>
+#include <Test.h>
+
+// Sends a byte in 4-bit mode as two bus cycles.
+static void sendByte(PololuHD44780Model & model, uint8_t data, bool rs)
+{
+    model.busCycle(data & 0xF0, rs);
+    model.busCycle(data << 4, rs);
+}
+
+static std::string line(const PololuHD44780Model & model, uint8_t y)
+{
+    std::string s;
+    for (uint8_t x = 0; x < 8; x++) { s += (char)model.characterAt(x, y); }
+    return s;
+}
+
+static void testFourBitInitialization()
+{
+    PololuHD44780Model model;
+    CHECK(model.eightBitInterface());
+
+    // The first function set commands are 8-bit, even on a 4-bit bus.
+    model.busCycle(0x30, false);
+    model.busCycle(0x30, false);
+    model.busCycle(0x30, false);
+    model.busCycle(0x20, false);
+    CHECK(!model.eightBitInterface());
+
+    sendByte(model, 0x28, false);
+    sendByte(model, 0x0C, false);
+    sendByte(model, 0x01, false);
+    sendByte(model, 0x06, false);
+    CHECK_EQUAL(0b100, model.displayControl());
+    CHECK_EQUAL(0b10, model.entryMode());
+    CHECK_EQUAL(12, model.busCycleCount());
+    CHECK_EQUAL(8, model.commandCount());
+
+    // 7 short instructions and one clear.
+    CHECK_EQUAL(7 * 37 + 1520, model.busyTime());
+}
+
+static void testDdram()
+{
+    PololuHD44780Model model;
+    model.busCycle(0x38, false);  // 8-bit, 2 lines
+    model.busCycle('h', true);
+    model.busCycle('i', true);
+    model.busCycle(0xC3, false);  // DDRAM address 0x43
+    model.busCycle('x', true);
+    CHECK_STRING("hi      ", line(model, 0));
+    CHECK_STRING("   x    ", line(model, 1));
+    CHECK_EQUAL(0x44, model.addressCounter());
+    CHECK_EQUAL(3, model.dataCount());
+
+    // The address counter goes from the end of the first line to the start
+    // of the second.
+    model.busCycle(0xA7, false);
+    model.busCycle('a', true);
+    model.busCycle('b', true);
+    CHECK_EQUAL('a', model.ddramByte(0x27));
+    CHECK_EQUAL('b', model.ddramByte(0x40));
+
+    // Lines 2 and 3 of a 20x4 LCD are the second halves of lines 0 and 1.
+    model.busCycle(0x94, false);
+    model.busCycle('c', true);
+    CHECK_EQUAL('c', model.characterAt(0, 2));
+}
+
+static void testEntryModeAndShift()
+{
+    PololuHD44780Model model;
+    model.busCycle(0x38, false);
+    model.busCycle(0x84, false);
+    model.busCycle(0x04, false);  // Decrement
+    model.busCycle('a', true);
+    model.busCycle('b', true);
+    CHECK_STRING("   ba   ", line(model, 0));
+
+    model.busCycle(0x18, false);  // Shift display left
+    CHECK_EQUAL(1, model.displayShift());
+    CHECK_STRING("  ba    ", line(model, 0));
+
+    model.busCycle(0x07, false);  // Increment and shift
+    model.busCycle('c', true);
+    CHECK_EQUAL(2, model.displayShift());
+
+    model.busCycle(0x01, false);  // Clear
+    CHECK_EQUAL(0, model.displayShift());
+    CHECK_EQUAL(0b11, model.entryMode());
+    CHECK_EQUAL(0, model.addressCounter());
+}
+
+static void testCgram()
+{
+    PololuHD44780Model model;
+    model.busCycle(0x38, false);
+    model.busCycle(0x48, false);  // CGRAM address 8
+    for (uint8_t i = 0; i < 8; i++) { model.busCycle(i + 1, true); }
+    CHECK(model.addressInCgram());
+    CHECK_EQUAL(1, model.cgramByte(8));
+    CHECK_EQUAL(8, model.cgramByte(15));
+    CHECK_STRING("        ", line(model, 0));
+}
+
+static void testResetCounters()
+{
+    PololuHD44780Model model;
+    model.busCycle(0x38, false);
+    model.busCycle('a', true);
+    model.resetCounters();
+    CHECK_EQUAL(0, model.busyTime());
+    CHECK_EQUAL(0, model.busCycleCount());
+    CHECK_EQUAL('a', model.ddramByte(0));
+}
+
+// The simulated LCD used by the other tests stays busy as long as the model
+// says each instruction takes.
+static void testHostLcdTiming()
+{
+    HostLcd lcd;
+    lcd.setLines(false, false, true, 0x38);
+    lcd.setLines(false, false, false, 0x38);
+    CHECK(lcd.busy());
+    CHECK_EQUAL(0, lcd.timingViolations);
+
+    lcd.setLines(false, false, true, 0x01);
+    lcd.setLines(false, false, false, 0x01);
+    CHECK_EQUAL(1, lcd.timingViolations);
+
+    hostAdvance(1520);
+    CHECK(!lcd.busy());
+}
+
+int main()
+{
+    testFourBitInitialization();
+    testDdram();
+    testEntryModeAndShift();
+    testCgram();
+    testResetCounters();
+    testHostLcdTiming();
+    return testResult();
+}
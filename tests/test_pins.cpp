@@ -0,0 +1,132 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+// Tests the pin-based classes in PololuHD44780.h against a simulated LCD,
+// checking what the screen shows, how many bus cycles were used, and that the
+// LCD was never sent anything while it was busy.
+
+#include <PololuHD44780.h>
+#include <HostLcd.h>
+#include <Test.h>
+
+static void testFourBit()
+{
+    HostLcd sim;
+    HostLcdPins pins(sim, 7, 255, 6, 5, 4, 3, 2);
+    PololuHD44780 lcd(7, 6, 5, 4, 3, 2);
+
+    lcd.clear();
+    lcd.print("hello");
+    lcd.gotoXY(3, 1);
+    lcd.print("world");
+    CHECK_STRING("hello               ", sim.row(0));
+    CHECK_STRING("   world            ", sim.row(1));
+    CHECK_EQUAL(0b100, sim.model.displayControl());
+    CHECK_EQUAL(0, sim.timingViolations);
+
+    // Each character is two bus cycles and takes a little more than the
+    // 37 us the LCD needs.
+    sim.model.resetCounters();
+    uint32_t start = hostTime();
+    lcd.print("0123456789");
+    uint32_t time = hostTime() - start;
+    CHECK_EQUAL(20, sim.model.busCycleCount());
+    CHECK(time >= 10 * 37);
+    CHECK(time <= 10 * 45);
+    CHECK_EQUAL(0, sim.timingViolations);
+}
+
+static void testBusyFlag()
+{
+    HostLcd sim;
+    HostLcdPins pins(sim, 7, 8, 6, 5, 4, 3, 2);
+    PololuHD44780RW lcd(7, 8, 6, 5, 4, 3, 2);
+
+    lcd.clear();
+    lcd.print("hello");
+    lcd.gotoXY(3, 1);
+    lcd.print("world");
+    CHECK_STRING("hello               ", sim.row(0));
+    CHECK_STRING("   world            ", sim.row(1));
+    CHECK_EQUAL(0, sim.timingViolations);
+
+    // Polling the busy flag lets the next command go out as soon as the
+    // clear finishes, instead of after the conservative default delay.
+    uint32_t start = hostTime();
+    lcd.clear();
+    lcd.print("x");
+    uint32_t time = hostTime() - start;
+    CHECK(time >= 1520);
+    CHECK(time < PololuHD44780Timing().clear);
+    CHECK_EQUAL(0, sim.timingViolations);
+}
+
+static void testEightBit()
+{
+    HostLcd sim;
+    const uint8_t db[8] = { 10, 11, 12, 13, 5, 4, 3, 2 };
+    HostLcdPins pins(sim, 7, 6, db);
+    PololuHD44780EightBit lcd(7, 6, 10, 11, 12, 13, 5, 4, 3, 2);
+
+    lcd.clear();
+    lcd.print("hello");
+    CHECK(sim.model.eightBitInterface());
+    CHECK_STRING("hello               ", sim.row(0));
+
+    sim.model.resetCounters();
+    lcd.print("0123456789");
+    CHECK_EQUAL(10, sim.model.busCycleCount());
+    CHECK_EQUAL(0, sim.timingViolations);
+}
+
+static void testBlockTransfers()
+{
+    HostLcd sim;
+    HostLcdPins pins(sim, 7, 255, 6, 5, 4, 3, 2);
+    PololuHD44780 lcd(7, 6, 5, 4, 3, 2);
+
+    static const uint8_t pictures[16] PROGMEM = {
+        1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16,
+    };
+
+    lcd.print(F("a flash string"));
+    lcd.loadCustomCharacters(pictures, 2, 2);
+    lcd.gotoXY(0, 1);
+    lcd.write((uint8_t)2);
+    CHECK_STRING("a flash string      ", sim.row(0));
+    CHECK_EQUAL(2, sim.row(1)[0]);
+    CHECK_EQUAL(1, sim.model.cgramByte(16));
+    CHECK_EQUAL(16, sim.model.cgramByte(31));
+    CHECK_EQUAL(0, sim.timingViolations);
+}
+
+static void testAsyncInit()
+{
+    HostLcd sim;
+    HostLcdPins pins(sim, 7, 255, 6, 5, 4, 3, 2);
+    PololuHD44780 lcd(7, 6, 5, 4, 3, 2);
+
+    // No call to initStep() should block for long.
+    lcd.beginAsync();
+    uint32_t longest = 0;
+    bool done = false;
+    while (!done)
+    {
+        uint32_t start = hostTime();
+        done = lcd.initStep();
+        if (hostTime() - start > longest) { longest = hostTime() - start; }
+    }
+    CHECK(longest < 50);
+    lcd.print("hi");
+    CHECK_STRING("hi  ", sim.row(0, 4));
+    CHECK_EQUAL(0, sim.timingViolations);
+}
+
+int main()
+{
+    testFourBit();
+    testBusyFlag();
+    testEightBit();
+    testBlockTransfers();
+    testAsyncInit();
+    return testResult();
+}
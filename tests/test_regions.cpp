@@ -0,0 +1,135 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+// Tests PololuHD44780Regions: the owner sends the latest text submitted to
+// each region, and only when it has changed.  The last test uses real
+// threads: several writers submit to their own regions as fast as they can
+// while the owner sends them to an emulated LCD, and the screen must never
+// show a mix of two texts.
+
+#include <PololuHD44780Regions.h>
+#include <PololuHD44780Model.h>
+#include <HostLcd.h>
+#include <Test.h>
+#include <atomic>
+#include <thread>
+
+static void testUpdate()
+{
+    PololuHD44780Emulator lcd(true);
+    PololuHD44780RegionBuffer<8> status(0, 0);
+    PololuHD44780RegionBuffer<6> speed(10, 1, PololuHD44780Field::alignRight);
+    PololuHD44780Regions regions(lcd);
+    regions.add(status);
+    regions.add(speed);
+    lcd.clear();
+
+    // Nothing is sent until the owner updates.
+    status.submit("ready");
+    speed.submit("12.3");
+    CHECK_STRING("        ", screenText(lcd.model, 0, 0, 8));
+    CHECK(regions.update());
+    CHECK_STRING("ready   ", screenText(lcd.model, 0, 0, 8));
+    CHECK_STRING("  12.3", screenText(lcd.model, 10, 1, 6));
+
+    // Only the last of several submissions is sent, and text that does not
+    // fit is cut off.
+    speed.submit("1");
+    speed.submit("123.456");
+    CHECK(regions.update());
+    CHECK_STRING("123.45", screenText(lcd.model, 10, 1, 6));
+
+    // With nothing submitted, an update sends nothing.
+    lcd.model.resetCounters();
+    CHECK(regions.update());
+    CHECK_EQUAL(0, lcd.model.busCycleCount());
+}
+
+static void testRemove()
+{
+    PololuHD44780Emulator lcd(true);
+    PololuHD44780RegionBuffer<4> a(0, 0), b(5, 0);
+    PololuHD44780Regions regions(lcd);
+    regions.add(a);
+    regions.add(b);
+    lcd.clear();
+
+    regions.remove(a);
+    a.submit("aaaa");
+    b.submit("bbbb");
+    CHECK(regions.update());
+    CHECK_STRING("     bbbb", screenText(lcd.model, 0, 0, 9));
+}
+
+static const uint8_t writerCount = 4;
+static const uint8_t width = 10;
+static const uint32_t submitCount = 200000;
+
+// Returns true if all the characters in the text are the same.
+static bool uniform(const std::string & text)
+{
+    return text.find_first_not_of(text[0]) == std::string::npos;
+}
+
+static void writer(PololuHD44780Region * region, uint8_t id)
+{
+    char text[width + 1];
+    for (uint32_t i = 0; i < submitCount; i++)
+    {
+        memset(text, 'A' + (i + id) % 26, width);
+        text[width] = 0;
+        region->submit(text);
+    }
+}
+
+static void testWriters()
+{
+    PololuHD44780Emulator lcd;
+    PololuHD44780RegionBuffer<width> a(0, 0), b(width, 0), c(0, 1), d(width, 1);
+    PololuHD44780Region * const regions[writerCount] = { &a, &b, &c, &d };
+    PololuHD44780Regions owner(lcd);
+    for (uint8_t i = 0; i < writerCount; i++) { owner.add(*regions[i]); }
+    lcd.clear();
+
+    std::atomic<uint8_t> running(writerCount);
+    std::thread threads[writerCount];
+    for (uint8_t i = 0; i < writerCount; i++)
+    {
+        threads[i] = std::thread([&, i]() {
+            writer(regions[i], i);
+            running--;
+        });
+    }
+
+    uint32_t updates = 0, torn = 0;
+    while (running)
+    {
+        owner.update();
+        updates++;
+        for (uint8_t i = 0; i < writerCount; i++)
+        {
+            if (!uniform(screenText(lcd.model, i % 2 * width, i / 2, width)))
+            {
+                torn++;
+            }
+        }
+    }
+    for (uint8_t i = 0; i < writerCount; i++) { threads[i].join(); }
+    CHECK(updates > 0);
+    CHECK_EQUAL(0, torn);
+
+    // Once the writers stop, the last text of each region gets sent.
+    while (!owner.update()) {}
+    for (uint8_t i = 0; i < writerCount; i++)
+    {
+        std::string expected(width, 'A' + (submitCount - 1 + i) % 26);
+        CHECK_STRING(expected, screenText(lcd.model, i % 2 * width, i / 2, width));
+    }
+}
+
+int main()
+{
+    testUpdate();
+    testRemove();
+    testWriters();
+    return testResult();
+}
@@ -0,0 +1,117 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+// Tests PololuHD44780SPI against a simulated 74HC595 shift register on a
+// simulated SPI bus.
+
+#include <PololuHD44780SPI.h>
+#include <HostLcd.h>
+#include <Test.h>
+
+// A 74HC595 whose outputs drive the LCD's RS, E, and DB4 through DB7 lines.
+// Bytes shifted in MSB first end up with bit 0 on QA, and a rising edge on
+// the latch pin copies them to the outputs.
+class ShiftRegister : public HostPinHandler, public HostSpiHandler
+{
+public:
+    ShiftRegister(HostLcd & lcd, uint8_t latch, uint8_t rsBit, uint8_t eBit,
+        uint8_t db4Bit)
+        : lcd(lcd), latch(latch), rsBit(rsBit), eBit(eBit), db4Bit(db4Bit),
+        shifted(0), latchLevel(LOW)
+    {
+        hostSetPinHandler(this);
+        hostSetSpiHandler(this);
+        SPI.hostReset();
+    }
+
+    ~ShiftRegister()
+    {
+        hostSetPinHandler(NULL);
+        hostSetSpiHandler(NULL);
+    }
+
+    virtual uint8_t transfer(uint8_t value)
+    {
+        shifted = value;
+        return 0;
+    }
+
+    virtual void digitalWrite(uint8_t pin, uint8_t value)
+    {
+        if (pin != latch) { return; }
+        if (value && !latchLevel)
+        {
+            lcd.setLines(shifted >> rsBit & 1, false, shifted >> eBit & 1,
+                (shifted >> db4Bit & 0x0F) << 4);
+        }
+        latchLevel = value;
+    }
+
+    virtual int digitalRead(uint8_t pin)
+    {
+        return pin == latch ? latchLevel : LOW;
+    }
+
+private:
+    HostLcd & lcd;
+    uint8_t latch, rsBit, eBit, db4Bit;
+    uint8_t shifted;
+    uint8_t latchLevel;
+};
+
+static void testPrint()
+{
+    HostLcd sim;
+    ShiftRegister shiftRegister(sim, 10, 1, 2, 4);
+    PololuHD44780SPI lcd(10);
+
+    lcd.clear();
+    lcd.print("hello");
+    lcd.gotoXY(3, 1);
+    lcd.print("world");
+    CHECK_STRING("hello               ", sim.row(0));
+    CHECK_STRING("   world            ", sim.row(1));
+    CHECK_EQUAL(0, sim.timingViolations);
+    CHECK_EQUAL(0, SPI.hostStrayTransfers);
+    CHECK(!SPI.hostInTransaction);
+}
+
+static void testOtherWiring()
+{
+    HostLcd sim;
+    ShiftRegister shiftRegister(sim, 9, 7, 6, 0);
+    PololuHD44780SPI lcd(9, 7, 6, 0);
+
+    lcd.clear();
+    lcd.print("0123456789");
+    CHECK_STRING("0123456789", sim.row(0, 10));
+    CHECK_EQUAL(0, sim.timingViolations);
+}
+
+static void testTransactions()
+{
+    HostLcd sim;
+    ShiftRegister shiftRegister(sim, 10, 1, 2, 4);
+    PololuHD44780SPI lcd(10);
+    lcd.clear();
+
+    // The bus is released while the LCD processes each character, so no
+    // transaction lasts as long as the 37 us the LCD needs for one.
+    SPI.hostReset();
+    uint32_t start = hostTime();
+    lcd.print("abcdefghijklmnopqrst");
+    uint32_t time = hostTime() - start;
+    CHECK_STRING("abcdefghijklmnopqrst", sim.row(0));
+    CHECK(SPI.hostLongestTransaction < 37);
+    CHECK(time >= 20 * 37);
+    CHECK(time < 20 * 50);
+    CHECK_EQUAL(0, sim.timingViolations);
+    CHECK_EQUAL(0, SPI.hostStrayTransfers);
+}
+
+int main()
+{
+    testPrint();
+    testOtherWiring();
+    testTransactions();
+    return testResult();
+}
@@ -0,0 +1,105 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+// Tests the statistics kept when POLOLU_HD44780_STATS is 1, by comparing
+// them with what the simulated LCD received.
+
+#include <PololuHD44780.h>
+#include <HostLcd.h>
+#include <Test.h>
+
+#if !POLOLU_HD44780_STATS
+#error "This test must be built with POLOLU_HD44780_STATS=1."
+#endif
+
+static void testDirect()
+{
+    HostLcd sim;
+    HostLcdPins pins(sim, 7, 255, 6, 5, 4, 3, 2);
+    PololuHD44780 lcd(7, 6, 5, 4, 3, 2);
+    const PololuHD44780Stats & stats = lcd.getStats();
+
+    // The initialization sequence is counted on its own, not as part of
+    // the clear() that caused it.
+    lcd.clear();
+    CHECK_EQUAL(1, stats.api[PololuHD44780Stats::init].calls);
+    CHECK(stats.api[PololuHD44780Stats::init].commands > 0);
+    CHECK(stats.api[PololuHD44780Stats::init].delayTime > 0);
+    CHECK_EQUAL(1, stats.api[PololuHD44780Stats::clear].calls);
+    CHECK_EQUAL(1, stats.api[PololuHD44780Stats::clear].commands);
+    CHECK_EQUAL(0, stats.api[PololuHD44780Stats::clear].dataBytes);
+    CHECK_EQUAL(2000, stats.api[PololuHD44780Stats::clear].delayTime);
+
+    // The initialization sequence clears the screen too.
+    CHECK_EQUAL(2, stats.clears);
+
+    // Each character and command is one transfer followed by the data or
+    // command time.
+    lcd.resetStats();
+    sim.model.resetCounters();
+    lcd.print("hello");
+    lcd.gotoXY(3, 1);
+    lcd.print("world");
+    CHECK_EQUAL(2, stats.api[PololuHD44780Stats::write].calls);
+    CHECK_EQUAL(0, stats.api[PololuHD44780Stats::write].commands);
+    CHECK_EQUAL(10, stats.api[PololuHD44780Stats::write].dataBytes);
+    CHECK_EQUAL(10 * 37, stats.api[PololuHD44780Stats::write].delayTime);
+    CHECK_EQUAL(1, stats.api[PololuHD44780Stats::gotoXY].calls);
+    CHECK_EQUAL(1, stats.api[PololuHD44780Stats::gotoXY].commands);
+    CHECK_EQUAL(0, stats.api[PololuHD44780Stats::gotoXY].dataBytes);
+    CHECK_EQUAL(37, stats.api[PololuHD44780Stats::gotoXY].delayTime);
+    CHECK_EQUAL(0, stats.api[PololuHD44780Stats::clear].calls);
+
+    // The totals match what the LCD saw.
+    CHECK_EQUAL(sim.model.commandCount(), stats.commands);
+    CHECK_EQUAL(sim.model.dataCount(), stats.dataBytes);
+    CHECK_EQUAL(sim.model.busCycleCount(), stats.busCycles);
+    CHECK_EQUAL(11 * 37, stats.delayTime);
+    CHECK_EQUAL(0, sim.timingViolations);
+}
+
+static void testFlush()
+{
+    HostLcd sim;
+    HostLcdPins pins(sim, 7, 255, 6, 5, 4, 3, 2);
+    PololuHD44780 lcd(7, 6, 5, 4, 3, 2);
+    PololuHD44780Framebuffer framebuffer;
+    const PololuHD44780Stats & stats = lcd.getStats();
+
+    lcd.enableFramebuffer(framebuffer);
+    lcd.print("Temp: 21.5 C");
+    lcd.flush();
+
+    // Drawing into the framebuffer sends nothing; the flush sends one
+    // address command and the run of characters from "1" to "5", and all of
+    // it is counted as part of the flush.
+    lcd.resetStats();
+    sim.model.resetCounters();
+    lcd.gotoXY(0, 0);
+    lcd.print("Temp: 22.0 C");
+    CHECK_EQUAL(0, stats.commands);
+    CHECK_EQUAL(0, stats.dataBytes);
+    CHECK_EQUAL(0, stats.delayTime);
+    lcd.flush();
+    CHECK_EQUAL(1, stats.api[PololuHD44780Stats::flush].calls);
+    CHECK_EQUAL(1, stats.api[PololuHD44780Stats::flush].commands);
+    CHECK_EQUAL(3, stats.api[PololuHD44780Stats::flush].dataBytes);
+    CHECK_EQUAL(4 * 37, stats.api[PololuHD44780Stats::flush].delayTime);
+    CHECK_EQUAL(sim.model.commandCount(), stats.commands);
+    CHECK_EQUAL(sim.model.dataCount(), stats.dataBytes);
+    CHECK_EQUAL(sim.model.busCycleCount(), stats.busCycles);
+
+    // A flush with nothing to send counts the call and nothing else.
+    lcd.resetStats();
+    lcd.flush();
+    CHECK_EQUAL(1, stats.api[PololuHD44780Stats::flush].calls);
+    CHECK_EQUAL(0, stats.commands + stats.dataBytes + stats.busCycles);
+    CHECK_EQUAL(0, stats.delayTime);
+    CHECK_EQUAL(0, sim.timingViolations);
+}
+
+int main()
+{
+    testDirect();
+    testFlush();
+    return testResult();
+}
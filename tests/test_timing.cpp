@@ -0,0 +1,90 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+// Tests timing profiles and calibrateTiming().
+
+#include <PololuHD44780.h>
+#include <HostLcd.h>
+#include <Test.h>
+
+static void testCalibration()
+{
+    HostLcd sim;
+    HostLcdPins pins(sim, 7, 8, 6, 5, 4, 3, 2);
+    PololuHD44780RW lcd(7, 8, 6, 5, 4, 3, 2);
+
+    lcd.print("x");
+    CHECK(lcd.calibrateTiming());
+    PololuHD44780Timing timing = lcd.getTiming();
+
+    // The measured times have some margin over what the LCD takes.
+    CHECK(timing.command >= 37 && timing.command < 80);
+    CHECK(timing.data >= 37 && timing.data < 80);
+    CHECK(timing.clear >= 1520 && timing.clear < 2000);
+    CHECK(timing.home >= 1520 && timing.home < 2000);
+
+    // Calibration leaves the screen blank.
+    CHECK_STRING("                    ", sim.row(0));
+    CHECK_EQUAL(0, sim.timingViolations);
+}
+
+static void testCalibrationWithFramebuffer()
+{
+    HostLcd sim;
+    HostLcdPins pins(sim, 7, 8, 6, 5, 4, 3, 2);
+    PololuHD44780RW lcd(7, 8, 6, 5, 4, 3, 2);
+    PololuHD44780Framebuffer framebuffer;
+    lcd.enableFramebuffer(framebuffer);
+
+    // The LCD really has to clear, not just the framebuffer.
+    lcd.print("x");
+    lcd.flush();
+    CHECK(lcd.calibrateTiming());
+    CHECK(lcd.getTiming().clear >= 1520);
+    CHECK_STRING("                    ", sim.row(0));
+
+    lcd.print("hi");
+    lcd.flush();
+    CHECK_STRING("hi   ", sim.row(0, 5));
+    CHECK_EQUAL(0, sim.timingViolations);
+}
+
+static void testCalibratedTimingWithoutBusyFlag()
+{
+    PololuHD44780Timing timing;
+    {
+        HostLcd sim;
+        HostLcdPins pins(sim, 7, 8, 6, 5, 4, 3, 2);
+        PololuHD44780RW lcd(7, 8, 6, 5, 4, 3, 2);
+        lcd.calibrateTiming();
+        timing = lcd.getTiming();
+    }
+
+    HostLcd sim;
+    HostLcdPins pins(sim, 7, 255, 6, 5, 4, 3, 2);
+    PololuHD44780 lcd(7, 6, 5, 4, 3, 2);
+    lcd.setTiming(timing);
+    lcd.clear();
+    lcd.print("hello");
+    lcd.home();
+    lcd.gotoXY(2, 1);
+    lcd.print("x");
+    CHECK_STRING("hello", sim.row(0, 5));
+    CHECK_EQUAL(0, sim.timingViolations);
+}
+
+static void testNoBusyFlag()
+{
+    HostLcd sim;
+    HostLcdPins pins(sim, 7, 255, 6, 5, 4, 3, 2);
+    PololuHD44780 lcd(7, 6, 5, 4, 3, 2);
+    CHECK(!lcd.calibrateTiming());
+}
+
+int main()
+{
+    testCalibration();
+    testCalibrationWithFramebuffer();
+    testCalibratedTimingWithoutBusyFlag();
+    testNoBusyFlag();
+    return testResult();
+}
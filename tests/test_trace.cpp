@@ -0,0 +1,80 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+// Tests trace buffers and the trace analyzer.
+
+#include <PololuHD44780Model.h>
+#include <PololuHD44780Trace.h>
+#include <HostLcd.h>
+#include <Test.h>
+
+typedef PololuHD44780TraceAnalyzer Analyzer;
+
+static void testAnalyzer()
+{
+    PololuHD44780Emulator lcd(true);
+    PololuHD44780TraceBuffer<200> trace;
+    lcd.enableTrace(trace);
+    lcd.init();
+
+    lcd.print("hi");
+    lcd.command(0x80 | 2);  // Redundant address
+    lcd.gotoXY(0, 0);
+    lcd.print("hi");  // Two identical characters
+    lcd.command(0x06);  // Unchanged entry mode
+    lcd.clear();  // Slower than writing two spaces
+    lcd.disableTrace();
+
+    Analyzer analyzer;
+    trace.replay(analyzer);
+    CHECK_EQUAL(trace.length(), analyzer.transfers);
+    CHECK_EQUAL(1, analyzer.waste[Analyzer::redundantAddress].count);
+    CHECK_EQUAL(2, analyzer.waste[Analyzer::identicalData].count);
+    CHECK_EQUAL(1, analyzer.waste[Analyzer::unchangedEntryMode].count);
+    CHECK_EQUAL(1, analyzer.waste[Analyzer::avoidableClear].count);
+    CHECK_EQUAL(' ', analyzer.model.ddramByte(0));
+}
+
+static void testRing()
+{
+    PololuHD44780TraceBuffer<4> trace;
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        trace.record(i, i & 1, false, 5000 + i);
+    }
+    CHECK_EQUAL(4, trace.length());
+    CHECK_EQUAL(6, trace.dropped());
+
+    PololuHD44780TraceRing::Entry entry = trace.get(0);
+    CHECK_EQUAL(6, entry.data);
+    CHECK(!entry.rsValue);
+    CHECK_EQUAL(5006, entry.delayTime);
+
+    // Long delays are limited to 14 bits.
+    trace.record(1, true, true, 60000);
+    entry = trace.get(3);
+    CHECK(entry.rsValue && entry.only4bits);
+    CHECK_EQUAL(0x3FFF, entry.delayTime);
+}
+
+static void testEightBitTrace()
+{
+    Analyzer analyzer;
+    analyzer.record(0x30, false, false, 4200);
+    analyzer.record(0x30, false, false, 150);
+    analyzer.record(0x30, false, false, 37);
+    analyzer.record(0x38, false, false, 37);
+    analyzer.record(0x01, false, false, 2000);
+    analyzer.record('A', true, false, 37);
+    analyzer.record(0x80, false, false, 37);
+    analyzer.record('A', true, false, 37);
+    CHECK_EQUAL('A', analyzer.model.ddramByte(0));
+    CHECK_EQUAL(1, analyzer.waste[Analyzer::identicalData].count);
+}
+
+int main()
+{
+    testAnalyzer();
+    testRing();
+    testEightBitTrace();
+    return testResult();
+}
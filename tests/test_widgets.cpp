@@ -0,0 +1,150 @@
+// Copyright Pololu Corporation.  For more information, see http://www.pololu.com/
+
+// Tests the glyph cache, bar graphs, and big digits.
+
+#include <PololuHD44780Model.h>
+#include <PololuHD44780Widgets.h>
+#include <HostLcd.h>
+#include <Test.h>
+
+// Like screenText(), but shows the full block as '#' and custom characters as
+// their slot numbers.
+static std::string cells(PololuHD44780Emulator & lcd, uint8_t x, uint8_t y,
+    uint8_t width)
+{
+    std::string s;
+    for (uint8_t i = 0; i < width; i++)
+    {
+        uint8_t c = lcd.model.characterAt(x + i, y);
+        s += c == 0xFF ? '#' : c < 8 ? (char)('0' + c) : (char)c;
+    }
+    return s;
+}
+
+static void testGlyphCache()
+{
+    uint8_t pictures[10][8];
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        for (uint8_t j = 0; j < 8; j++) { pictures[i][j] = i * 8 + j; }
+    }
+
+    PololuHD44780Emulator lcd(true);
+    PololuHD44780GlyphCache cache(lcd);
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        uint8_t slot = cache.acquireFromRam(100 + i, pictures[i]);
+        CHECK_EQUAL(i * 8, lcd.model.cgramByte(slot * 8));
+    }
+    CHECK_EQUAL(PololuHD44780GlyphCache::noSlot,
+        cache.acquireFromRam(200, pictures[8]));
+
+    // Acquiring a glyph that is already loaded sends nothing.
+    cache.release(103);
+    lcd.model.resetCounters();
+    cache.acquireFromRam(105, pictures[5]);
+    CHECK_EQUAL(0, lcd.model.busCycleCount());
+
+    // A released slot can be reused.
+    uint8_t slot = cache.acquireFromRam(200, pictures[8]);
+    CHECK(slot != PololuHD44780GlyphCache::noSlot);
+    CHECK_EQUAL(64, lcd.model.cgramByte(slot * 8));
+}
+
+static void testHorizontalBar()
+{
+    PololuHD44780Emulator lcd(true);
+    PololuHD44780GlyphCache glyphs(lcd);
+    PololuHD44780BarGraph bar(lcd, glyphs, 0, 1, 10);
+    lcd.clear();
+
+    bar.showLevel(12);
+    CHECK_STRING("##1       ", cells(lcd, 0, 1, 10));
+
+    // One more column of dots only changes one cell.
+    lcd.model.resetCounters();
+    bar.showLevel(13);
+    CHECK_STRING("##2       ", cells(lcd, 0, 1, 10));
+    CHECK_EQUAL(1, lcd.model.commandCount());
+    CHECK_EQUAL(1, lcd.model.dataCount());
+
+    lcd.model.resetCounters();
+    bar.showLevel(13);
+    CHECK_EQUAL(0, lcd.model.busCycleCount());
+
+    bar.showLevel(50);
+    CHECK_STRING("##########", cells(lcd, 0, 1, 10));
+    bar.showLevel(0);
+    CHECK_STRING("          ", cells(lcd, 0, 1, 10));
+    bar.show(2000, 1000);
+    CHECK_STRING("##########", cells(lcd, 0, 1, 10));
+}
+
+static void testVerticalBar()
+{
+    PololuHD44780Emulator lcd(true);
+    PololuHD44780GlyphCache glyphs(lcd);
+    PololuHD44780BarGraph bar(lcd, glyphs, 19, 3, 4,
+        PololuHD44780BarGraph::vertical);
+    lcd.clear();
+
+    bar.showLevel(11);
+    CHECK_EQUAL(0xFF, lcd.model.characterAt(19, 3));
+    CHECK_EQUAL(' ', lcd.model.characterAt(19, 1));
+
+    // The cell above the full one has its bottom 3 rows of dots on.
+    uint8_t c = lcd.model.characterAt(19, 2);
+    CHECK(c < 8);
+    for (uint8_t r = 0; r < 8; r++)
+    {
+        CHECK_EQUAL(r >= 5 ? 0x1F : 0, lcd.model.cgramByte(c * 8 + r));
+    }
+}
+
+static void testTallVerticalBar()
+{
+    // A bar taller than the rows above it is cut off at the top row instead
+    // of wrapping around to row 255.
+    PololuHD44780Emulator lcd(true);
+    PololuHD44780GlyphCache glyphs(lcd);
+    PololuHD44780BarGraph bar(lcd, glyphs, 5, 1, 6,
+        PololuHD44780BarGraph::vertical);
+    lcd.clear();
+    CHECK_EQUAL(2 * 8, bar.maxLevel());
+
+    bar.showLevel(100);
+    CHECK_EQUAL(0xFF, lcd.model.characterAt(5, 1));
+    CHECK_EQUAL(0xFF, lcd.model.characterAt(5, 0));
+    CHECK_EQUAL(' ', lcd.model.characterAt(5, 2));
+    CHECK_EQUAL(' ', lcd.model.characterAt(5, 3));
+}
+
+static void testBigDigits()
+{
+    PololuHD44780Emulator lcd(true);
+    PololuHD44780GlyphCache glyphs(lcd);
+    PololuHD44780BigDigits digits(lcd, glyphs, 0, 0, 4);
+    lcd.clear();
+
+    digits.show(1238);
+    lcd.model.resetCounters();
+    digits.show(1239);
+    CHECK_EQUAL(1, lcd.model.dataCount());
+
+    // Leading zeros are blank.
+    digits.show(7);
+    CHECK_STRING("            ", cells(lcd, 0, 0, 12));
+    digits.show(0);
+    CHECK_STRING("            ", cells(lcd, 0, 0, 12));
+    CHECK(cells(lcd, 12, 0, 3) != "   ");
+}
+
+int main()
+{
+    testGlyphCache();
+    testHorizontalBar();
+    testVerticalBar();
+    testTallVerticalBar();
+    testBigDigits();
+    return testResult();
+}